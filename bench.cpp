@@ -0,0 +1,98 @@
+#include "engine.hpp"
+#include <chrono>
+
+/**
+ * @brief a position of the benchmark, the bitboards of the black pieces, the white pieces and the kings, and the side to move.
+ */
+struct BenchPosition {
+    const char* name;
+    uint32_t black;
+    uint32_t white;
+    uint32_t kings;
+    bool black_turn;
+};
+
+// openings, middlegames, positions with captures to make and endgames of kings, from games of the engine against itself.
+const BenchPosition BENCH_POSITIONS[] = {
+    { "start", 0xfff00000, 0x00000fff, 0x00000000, true },
+    { "opening 1", 0xfe900000, 0x0000899f, 0x00000000, true },
+    { "opening 2", 0xf9d40000, 0x000043f7, 0x00000000, true },
+    { "opening 3", 0xfad20000, 0x00002d3f, 0x00000000, true },
+    { "opening 4", 0xff380000, 0x000096df, 0x00000000, true },
+    { "middlegame 1", 0xd0d00000, 0x00007831, 0x00000000, true },
+    { "middlegame 2", 0xf8300800, 0x0008211e, 0x00000000, true },
+    { "middlegame 3", 0xf0d00000, 0x0002a01d, 0x00000000, true },
+    { "middlegame 4", 0xb0140800, 0x00020219, 0x00000000, true },
+    { "captures 1", 0xf0140000, 0x0400a01d, 0x00000000, true },
+    { "captures 2", 0xf4943000, 0x00008f78, 0x00000000, false },
+    { "captures 3", 0xfc160200, 0x000004ff, 0x00000000, false },
+    { "captures 4", 0x18031008, 0x40502860, 0x40000008, true },
+    { "captures 5", 0x70410000, 0x00061098, 0x00000000, false },
+    { "kings 1", 0x00063000, 0x81000000, 0x81040000, true },
+    { "kings 2", 0x00042500, 0x08020000, 0x08060000, true },
+    { "kings 3", 0x00006108, 0x00800000, 0x00804008, true },
+    { "kings 4", 0x80100000, 0x38000000, 0x30100000, true }
+};
+
+/**
+ * @brief searches every position of the benchmark to depth with a new engine, and prints the nodes, time and nodes per second of each and of all of them.
+ * with one thread the total nodes are the same on every machine, and only change when the search does, so they serve as a signature of the search.
+ *
+ * usage: bench [depth] [threads] [lazy]
+ */
+int main(int argc, char** argv) {
+    const unsigned int depth = argc > 1 ? std::stoul(argv[1]) : 12;
+    const unsigned int threads = argc > 2 ? std::stoul(argv[2]) : 1;
+    const ParallelMode mode = argc > 3 && std::string(argv[3]) == "lazy" ? ParallelMode::LAZY_SMP : ParallelMode::SPLIT;
+
+    if (depth < 1 || depth > MAX_DEPTH) {
+        std::cerr << "usage: " << argv[0] << " [depth] [threads] [lazy], depth must be between 1 and " << MAX_DEPTH << std::endl;
+        return 1;
+    }
+
+    uint64_t total_nodes = 0;
+    uint64_t total_quiescence_nodes = 0;
+    double total_seconds = 0;
+    SearchStats total_stats;
+
+    for (const auto& position : BENCH_POSITIONS) {
+        // a new engine for every position, so nothing it learned from the previous one changes the search.
+        Engine engine(DEFAULT_TABLE_MEGABYTES, threads, mode);
+        const SearchLimits limits{ depth, 0, 0 };
+        SearchControl control(limits);
+
+        const auto [board, eval] = engine.best_move(BitBoard(position.black, position.white, position.kings), position.black_turn, limits, control);
+        const uint64_t nodes = control.get_nodes();
+        total_quiescence_nodes += control.get_quiescence_nodes();
+        const double seconds = control.elapsed();
+        total_nodes += nodes;
+        total_seconds += seconds;
+        total_stats.add(control.get_stats());
+
+        std::cout << std::left << std::setw(14) << position.name << std::right
+            << " eval " << std::setw(6) << eval << ", " << std::setw(11) << nodes << " nodes, "
+            << std::fixed << std::setprecision(3) << seconds << "s, " << (uint64_t)(nodes / std::max(seconds, 1e-9)) << " nodes/s" << std::endl;
+    }
+
+    std::cout << "depth " << depth << ", " << threads << (threads == 0 ? " (all) threads, " : " threads, ") << (mode == ParallelMode::LAZY_SMP ? "lazy smp" : "split") << std::endl;
+    std::cout << "total: " << total_nodes << " nodes, " << std::fixed << std::setprecision(3) << total_seconds << "s, "
+        << (uint64_t)(total_nodes / std::max(total_seconds, 1e-9)) << " nodes/s" << std::endl;
+    std::cout << "past depth to resolve captures: " << total_quiescence_nodes << " nodes" << std::endl;
+    std::cout << "signature: " << total_nodes << std::endl;
+
+#ifdef SEARCH_STATS
+    std::cout << "evaluations: " << total_stats.evaluations << ", table hits: " << total_stats.table_hits << " of " << total_stats.table_probes << " probes" << std::endl;
+    uint64_t cutoffs = 0;
+    for (const uint64_t count : total_stats.cutoffs)
+        cutoffs += count;
+    std::cout << "cutoffs by move:";
+    for (unsigned int i = 0; i < CUTOFF_INDICES; i++)
+        std::cout << " " << std::setprecision(1) << 100.0 * total_stats.cutoffs[i] / std::max(cutoffs, (uint64_t)1) << "%";
+    std::cout << std::endl << "branching by ply:";
+    for (unsigned int level = 0; level < depth; level++)
+        std::cout << " " << std::setprecision(2) << total_stats.branching_factor(level);
+    std::cout << std::endl;
+#endif
+
+    return 0;
+}
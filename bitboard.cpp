@@ -3,6 +3,85 @@
 unsigned int get_board_index(const unsigned int x, const unsigned int y);
 std::pair<unsigned int, unsigned int> board_index_to_xy(const unsigned int index);
 
+/**
+ * @brief shifts every square in bits one diagonal step to (x - 1, y - 1), squares that leave the board are dropped.
+ *
+ * @param bits
+ * @return uint32_t
+ */
+constexpr uint32_t up_left(const uint32_t bits) {
+    return ((bits & EVEN_ROWS) >> 4) | ((bits & ODD_ROWS & ~FIRST_IN_ROW) >> 5);
+}
+
+/**
+ * @brief shifts every square in bits one diagonal step to (x + 1, y - 1), squares that leave the board are dropped.
+ *
+ * @param bits
+ * @return uint32_t
+ */
+constexpr uint32_t up_right(const uint32_t bits) {
+    return ((bits & EVEN_ROWS & ~LAST_IN_ROW) >> 3) | ((bits & ODD_ROWS) >> 4);
+}
+
+/**
+ * @brief shifts every square in bits one diagonal step to (x - 1, y + 1), squares that leave the board are dropped.
+ *
+ * @param bits
+ * @return uint32_t
+ */
+constexpr uint32_t down_left(const uint32_t bits) {
+    return ((bits & EVEN_ROWS) << 4) | ((bits & ODD_ROWS & ~FIRST_IN_ROW) << 3);
+}
+
+/**
+ * @brief shifts every square in bits one diagonal step to (x + 1, y + 1), squares that leave the board are dropped.
+ *
+ * @param bits
+ * @return uint32_t
+ */
+constexpr uint32_t down_right(const uint32_t bits) {
+    return ((bits & EVEN_ROWS & ~LAST_IN_ROW) << 5) | ((bits & ODD_ROWS) << 4);
+}
+
+typedef uint32_t(*Diagonal)(const uint32_t);
+// DIAGONALS[d] and DIAGONALS[3 - d] are opposite directions, the first two go UP (black men) and the last two go DOWN (white men).
+constexpr Diagonal DIAGONALS[] = { up_left, up_right, down_left, down_right };
+constexpr unsigned int NUM_DIAGONALS = 4;
+
+/**
+ * @brief the squares the moving piece stands on during move, from its source to its destination, one more for every jump.
+ *
+ * @param move
+ * @return std::vector<unsigned int>
+ */
+std::vector<unsigned int> move_squares(const Move& move) {
+    std::vector<unsigned int> squares = { move.from };
+    const unsigned int jumps = std::popcount(move.captured);
+
+    uint32_t square = 1U << move.from;
+    for (unsigned int jump = 0; jump < jumps; jump++) {
+        const auto diagonal = DIAGONALS[(move.path >> (2 * jump)) & 3];
+        square = diagonal(diagonal(square));
+        squares.push_back(std::countr_zero(square));
+    }
+
+    if (jumps == 0)
+        squares.push_back(move.to);
+    return squares;
+}
+
+/**
+ * @brief can a man of the side to move step in the direction of DIAGONALS[diagonal].
+ *
+ * @param black_turn
+ * @param diagonal
+ * @return true
+ * @return false
+ */
+constexpr bool is_forward(const bool black_turn, const unsigned int diagonal) {
+    return black_turn == (diagonal < NUM_DIAGONALS / 2);
+}
+
 /**
  * @brief given an index to the bitboard return the corresponding x,y coordinates.
  *
@@ -23,36 +102,211 @@ unsigned int get_board_index(const unsigned int x, const unsigned int y) {
     return (x >> 1) + (y << 2);
 }
 
-BitBoard::BitBoard() {}
+/**
+ * @brief one step of the splitmix64 generator, used to fill the zobrist tables at compile time.
+ *
+ * @param state
+ * @return uint64_t
+ */
+constexpr uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct ZobristKeys {
+    // pieces[piece_kind][square], see zobrist_kind.
+    uint64_t pieces[4][NUMBER_OF_REACHABLE_SQUARES];
+    uint64_t black_turn;
+};
+
+constexpr ZobristKeys make_zobrist_keys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x636865636B657273ULL;
+
+    for (auto& kind : keys.pieces)
+        for (auto& key : kind)
+            key = splitmix64(state);
+    keys.black_turn = splitmix64(state);
+
+    return keys;
+}
+
+constexpr ZobristKeys ZOBRIST = make_zobrist_keys();
+
+/**
+ * @brief the row of the zobrist table of a piece: black man, white man, black king, white king.
+ *
+ * @param black
+ * @param king
+ * @return unsigned int
+ */
+constexpr unsigned int zobrist_kind(const bool black, const bool king) {
+    return (black ? 0 : 1) + (king ? 2 : 0);
+}
+
+/**
+ * @brief the evaluation of a single piece on a square, for white: material is worth the most, then being in the center, then being on a side.
+ * a board is evaluated as the sum over its pieces, which is what lets it keep its evaluation up to date one piece at a time.
+ *
+ * @param king
+ * @param index
+ * @return short
+ */
+constexpr short piece_square_value(const bool king, const unsigned int index) {
+    const uint32_t bit = 1U << index;
+    return (king ? KING_VALUE : MAN_VALUE) + CENTER_VALUE * ((CENTER_SQUARES & bit) != 0) + EDGE_VALUE * ((EDGE_SQUARES & bit) != 0)
+        + CORNER_VALUE * ((CORNER_SQUARES & bit) != 0);
+}
+
+typedef std::array<std::array<short, NUMBER_OF_REACHABLE_SQUARES>, 4> PieceSquareTable;
+
+constexpr PieceSquareTable make_piece_square_values() {
+    PieceSquareTable values{};
+    for (unsigned int index = 0; index < NUMBER_OF_REACHABLE_SQUARES; index++) {
+        for (const bool king : { false, true }) {
+            values[zobrist_kind(true, king)][index] = -piece_square_value(king, index);
+            values[zobrist_kind(false, king)][index] = piece_square_value(king, index);
+        }
+    }
+    return values;
+}
+
+// PIECE_SQUARE_VALUES[piece_kind][square] => what the piece adds to the evaluation, see zobrist_kind.
+constexpr PieceSquareTable PIECE_SQUARE_VALUES = make_piece_square_values();
+
+BitBoard::BitBoard() : key(this->compute_key()), score(this->compute_score()) {}
 BitBoard::BitBoard(const BitBoard& other) :
-    black_is_in(other.black_is_in), white_is_in(other.white_is_in), kings(other.kings) {}
+    black_is_in(other.black_is_in), white_is_in(other.white_is_in), kings(other.kings), key(other.key), score(other.score) {}
+
+/**
+ * @brief construct a board from the squares of each kind of piece, bit index = (x >> 1) + (y << 2).
+ *
+ * @param black squares of the black pieces.
+ * @param white squares of the white pieces.
+ * @param kings squares of the kings of both colors.
+ */
+BitBoard::BitBoard(const uint32_t black, const uint32_t white, const uint32_t kings) :
+    black_is_in(black), white_is_in(white), kings(kings & (black | white)) {
+    this->key = this->compute_key();
+    this->score = this->compute_score();
+}
+
+/**
+ * @brief can the board hold the pieces: no square has two pieces, every king is a piece, and no man is on the row it is crowned on.
+ *
+ * @param black
+ * @param white
+ * @param kings
+ * @return true
+ * @return false
+ */
+bool BitBoard::valid(const uint32_t black, const uint32_t white, const uint32_t kings) {
+    const uint32_t men = (black | white) & ~kings;
+    return (black & white) == 0 && (kings & ~(black | white)) == 0
+        && (men & black & BLACK_PROMOTION_ROW) == 0 && (men & white & WHITE_PROMOTION_ROW) == 0;
+}
 
 bool BitBoard::operator==(const BitBoard& other) const {
-    return this->black_is_in == other.black_is_in && this->white_is_in == other.white_is_in && this->kings == other.kings;
+    return this->key == other.key && this->black_is_in == other.black_is_in && this->white_is_in == other.white_is_in && this->kings == other.kings;
 }
 
 bool BitBoard::operator!=(const BitBoard& other) const {
-    return this->black_is_in != other.black_is_in || this->white_is_in != other.white_is_in || this->kings != other.kings;
+    return !(*this == other);
 }
 
 BitBoard& BitBoard::operator=(const BitBoard& other) {
     this->black_is_in = other.black_is_in;
     this->white_is_in = other.white_is_in;
     this->kings = other.kings;
+    this->key = other.key;
+    this->score = other.score;
     return *this;
 }
 
 /**
- * @brief hashes a bitboard
+ * @brief hashes a bitboard, this is the incrementally kept zobrist key so it costs nothing.
  *
  * @param board
  * @return std::size_t
  */
 std::size_t BitBoard::hasher::operator()(const BitBoard& board) const {
-    std::size_t seed = (std::size_t)board.black_is_in.to_ulong();
-    seed |= (std::size_t)board.white_is_in.to_ulong() << (sizeof(std::size_t) * 8 - sizeof(board.white_is_in) * 8);
-    boost::hash_combine(seed, board.kings.to_ulong() << (sizeof(std::size_t) * 4 - sizeof(board.kings)));
-    return seed;
+    return board.key;
+}
+
+/**
+ * @brief the zobrist key of the position with black_turn as the side to move.
+ *
+ * @param black_turn
+ * @return uint64_t
+ */
+uint64_t BitBoard::hash(const bool black_turn) const {
+    return black_turn ? this->key ^ ZOBRIST.black_turn : this->key;
+}
+
+/**
+ * @brief calculates the zobrist key of the pieces from scratch, the key is kept up to date incrementally after construction.
+ *
+ * @return uint64_t
+ */
+uint64_t BitBoard::compute_key() const {
+    uint64_t result = 0;
+
+    for (uint32_t pieces = this->black_is_in | this->white_is_in; pieces; pieces &= pieces - 1) {
+        const uint32_t bit = pieces & -pieces;
+        result ^= ZOBRIST.pieces[zobrist_kind(this->black_is_in & bit, this->kings & bit)][std::countr_zero(bit)];
+    }
+
+    return result;
+}
+
+/**
+ * @brief the static evaluation of the pieces, this is the incrementally kept score so it costs nothing.
+ *
+ * @return short
+ */
+short BitBoard::evaluation() const {
+    return this->score;
+}
+
+/**
+ * @brief calculates the evaluation of the pieces from scratch with a popcount of the pieces in every region,
+ * the evaluation is kept up to date incrementally after construction.
+ *
+ * @return short
+ */
+short BitBoard::compute_score() const {
+    const uint32_t white = this->white_is_in;
+    const uint32_t black = this->black_is_in;
+    const auto balance = [white, black](const uint32_t mask) { return std::popcount(white & mask) - std::popcount(black & mask); };
+
+    return MAN_VALUE * balance(~this->kings) + KING_VALUE * balance(this->kings) + CENTER_VALUE * balance(CENTER_SQUARES)
+        + EDGE_VALUE * balance(EDGE_SQUARES) + CORNER_VALUE * balance(CORNER_SQUARES);
+}
+
+/**
+ * @brief accounts for the piece described by black, king put on square index in the zobrist key and the evaluation.
+ *
+ * @param black
+ * @param king
+ * @param index
+ */
+void BitBoard::add_piece(const bool black, const bool king, const unsigned int index) {
+    this->key ^= ZOBRIST.pieces[zobrist_kind(black, king)][index];
+    this->score += PIECE_SQUARE_VALUES[zobrist_kind(black, king)][index];
+}
+
+/**
+ * @brief accounts for the piece described by black, king taken off square index in the zobrist key and the evaluation.
+ *
+ * @param black
+ * @param king
+ * @param index
+ */
+void BitBoard::remove_piece(const bool black, const bool king, const unsigned int index) {
+    this->key ^= ZOBRIST.pieces[zobrist_kind(black, king)][index];
+    this->score -= PIECE_SQUARE_VALUES[zobrist_kind(black, king)][index];
 }
 
 std::bitset<NUMBER_OF_REACHABLE_SQUARES> BitBoard::operator^(const BitBoard& other) const {
@@ -64,11 +318,11 @@ std::bitset<NUMBER_OF_REACHABLE_SQUARES> BitBoard::operator&(const BitBoard& oth
 }
 
 std::bitset<NUMBER_OF_REACHABLE_SQUARES> BitBoard::operator^(std::bitset<NUMBER_OF_REACHABLE_SQUARES> other) const {
-    return (this->black_is_in | this->white_is_in | this->kings) ^ other;
+    return std::bitset<NUMBER_OF_REACHABLE_SQUARES>(this->black_is_in | this->white_is_in | this->kings) ^ other;
 }
 
 std::bitset<NUMBER_OF_REACHABLE_SQUARES> BitBoard::operator&(std::bitset<NUMBER_OF_REACHABLE_SQUARES> other) const {
-    return (this->black_is_in | this->white_is_in | this->kings) & other;
+    return std::bitset<NUMBER_OF_REACHABLE_SQUARES>(this->black_is_in | this->white_is_in | this->kings) & other;
 }
 
 std::bitset<NUMBER_OF_REACHABLE_SQUARES> operator^(std::bitset<NUMBER_OF_REACHABLE_SQUARES> bits, const BitBoard& board) {
@@ -79,19 +333,27 @@ std::bitset<NUMBER_OF_REACHABLE_SQUARES> operator&(std::bitset<NUMBER_OF_REACHAB
 }
 
 bool BitBoard::is_black(const unsigned int x, const unsigned int y) const {
-    return this->black_is_in[get_board_index(x, y)];
+    return (this->black_is_in >> get_board_index(x, y)) & 1U;
 }
 
 bool BitBoard::is_white(const unsigned int x, const unsigned int y) const {
-    return this->white_is_in[get_board_index(x, y)];
+    return (this->white_is_in >> get_board_index(x, y)) & 1U;
 }
 
 bool BitBoard::is_king(const unsigned int x, const unsigned int y) const {
-    return this->kings[get_board_index(x, y)];
+    return (this->kings >> get_board_index(x, y)) & 1U;
 }
 
 void BitBoard::set_king(const unsigned int x, const unsigned int y) {
-    this->kings[get_board_index(x, y)] = true;
+    const unsigned int index = get_board_index(x, y);
+    const uint32_t bit = 1U << index;
+
+    // only a piece that is not a king yet changes.
+    if ((this->black_is_in | this->white_is_in) & ~this->kings & bit) {
+        this->remove_piece(this->black_is_in & bit, false, index);
+        this->add_piece(this->black_is_in & bit, true, index);
+    }
+    this->kings |= bit;
 }
 
 bool BitBoard::is_black(const std::pair<const unsigned int, const unsigned int> coords) const {
@@ -126,7 +388,7 @@ bool in_bounds(const unsigned int index) {
  * @return short
  */
 short BitBoard::num_white() const {
-    return this->white_is_in.count();
+    return std::popcount(this->white_is_in);
 }
 
 /**
@@ -135,7 +397,7 @@ short BitBoard::num_white() const {
  * @return short
  */
 short BitBoard::num_black() const {
-    return this->black_is_in.count();
+    return std::popcount(this->black_is_in);
 }
 
 /**
@@ -144,7 +406,7 @@ short BitBoard::num_black() const {
  * @return short
  */
 short BitBoard::num_white_kings() const {
-    return (this->white_is_in & this->kings).count();
+    return std::popcount(this->white_is_in & this->kings);
 }
 
 /**
@@ -153,7 +415,7 @@ short BitBoard::num_white_kings() const {
  * @return short
  */
 short BitBoard::num_black_kings() const {
-    return (this->black_is_in & this->kings).count();
+    return std::popcount(this->black_is_in & this->kings);
 }
 
 /**
@@ -272,21 +534,189 @@ BitBoard BitBoard::capture(const unsigned int source_x, const unsigned int sourc
 }
 
 /**
- * @brief returns all the legal captures from coordinates (x, y) given that is is blacks turn if black_turn.
+ * @brief returns the empty squares of the board.
+ *
+ * @return uint32_t
+ */
+uint32_t BitBoard::empty() const {
+    return ~(this->black_is_in | this->white_is_in);
+}
+
+/**
+ * @brief returns the squares of the black pieces.
+ *
+ * @return uint32_t
+ */
+uint32_t BitBoard::black_pieces() const {
+    return this->black_is_in;
+}
+
+/**
+ * @brief returns the squares of the white pieces.
+ *
+ * @return uint32_t
+ */
+uint32_t BitBoard::white_pieces() const {
+    return this->white_is_in;
+}
+
+/**
+ * @brief returns the squares of the kings of both colors.
+ *
+ * @return uint32_t
+ */
+uint32_t BitBoard::king_pieces() const {
+    return this->kings;
+}
+
+/**
+ * @brief returns the squares of all the pieces of the side to move that have a non-capture move.
  *
  * @param black_turn
- * @param x
- * @param y
+ * @return uint32_t
+ */
+uint32_t BitBoard::movers(const bool black_turn) const {
+    const uint32_t own = black_turn ? this->black_is_in : this->white_is_in;
+    const uint32_t empty = this->empty();
+    uint32_t result = 0;
+
+    for (unsigned int d = 0; d < NUM_DIAGONALS; d++) {
+        const uint32_t pieces = is_forward(black_turn, d) ? own : own & this->kings;
+        // a piece can step in direction d if one step in the opposite direction from an empty square reaches it.
+        result |= pieces & DIAGONALS[NUM_DIAGONALS - 1 - d](empty);
+    }
+
+    return result;
+}
+
+/**
+ * @brief returns the squares of all the pieces of the side to move that can capture.
+ *
+ * @param black_turn
+ * @return uint32_t
+ */
+uint32_t BitBoard::jumpers(const bool black_turn) const {
+    const uint32_t own = black_turn ? this->black_is_in : this->white_is_in;
+    const uint32_t other = black_turn ? this->white_is_in : this->black_is_in;
+    const uint32_t empty = this->empty();
+    uint32_t result = 0;
+
+    for (unsigned int d = 0; d < NUM_DIAGONALS; d++) {
+        const uint32_t pieces = is_forward(black_turn, d) ? own : own & this->kings;
+        const auto back = DIAGONALS[NUM_DIAGONALS - 1 - d];
+        // an opponent piece with an empty square behind it, stepped back once more reaches the capturing piece.
+        result |= pieces & back(other & back(empty));
+    }
+
+    return result;
+}
+
+/**
+ * @brief the position after the piece on source steps to the empty dest, source and dest are single bits, assumes legal input.
+ *
+ * @param black_turn
+ * @param source
+ * @param dest
+ * @return BitBoard
+ */
+BitBoard BitBoard::step(const bool black_turn, const uint32_t source, const uint32_t dest) const {
+    BitBoard end_position(*this);
+    uint32_t& own = black_turn ? end_position.black_is_in : end_position.white_is_in;
+    const bool king = this->kings & source;
+
+    own ^= source | dest;
+    if (king)
+        end_position.kings ^= source | dest;
+    else if (dest & (BLACK_PROMOTION_ROW | WHITE_PROMOTION_ROW))
+        end_position.kings |= dest;
+
+    end_position.remove_piece(black_turn, king, std::countr_zero(source));
+    end_position.add_piece(black_turn, end_position.kings & dest, std::countr_zero(dest));
+    return end_position;
+}
+
+/**
+ * @brief the position after the piece on source jumps over captured to dest, all are single bits, assumes legal input.
+ *
+ * @param black_turn
+ * @param source
+ * @param captured
+ * @param dest
+ * @return BitBoard
+ */
+BitBoard BitBoard::jump(const bool black_turn, const uint32_t source, const uint32_t captured, const uint32_t dest) const {
+    BitBoard end_position = this->step(black_turn, source, dest);
+    uint32_t& other = black_turn ? end_position.white_is_in : end_position.black_is_in;
+
+    end_position.remove_piece(!black_turn, this->kings & captured, std::countr_zero(captured));
+    other &= ~captured;
+    end_position.kings &= ~captured;
+
+    return end_position;
+}
+
+/**
+ * @brief adds to result every move that ends a maximal series of captures, this board is the position reached by move so far
+ * and source is the square the capturing piece is on. assumes the piece can capture at least once,
+ * a piece that is crowned mid-series continues capturing as a king.
+ *
+ * @param black_turn
+ * @param move
+ * @param source
+ * @param result
+ */
+void BitBoard::jump_sequences(const bool black_turn, Move move, const uint32_t source, MoveList& result) const {
+    const uint32_t other = black_turn ? this->white_is_in : this->black_is_in;
+    const uint32_t empty = this->empty();
+    const bool king = this->kings & source;
+    bool captured_any = false;
+
+    for (unsigned int d = 0; d < NUM_DIAGONALS; d++) {
+        if (!king && !is_forward(black_turn, d))
+            continue;
+
+        const uint32_t captured = DIAGONALS[d](source) & other;
+        const uint32_t dest = DIAGONALS[d](captured) & empty;
+        if (!dest)
+            continue;
+
+        captured_any = true;
+        Move next = move;
+        next.path |= d << (2 * std::popcount(move.captured));
+        next.captured |= captured;
+        next.captured_kings |= this->kings & captured;
+        next.promotion |= !king && (dest & (BLACK_PROMOTION_ROW | WHITE_PROMOTION_ROW));
+        this->jump(black_turn, source, captured, dest).jump_sequences(black_turn, next, dest, result);
+    }
+
+    if (!captured_any) {
+        move.to = std::countr_zero(source);
+        // different capture orders may end in the same position, each of them is a move of its own.
+        result.push_back(move);
+    }
+}
+
+/**
+ * @brief returns the positions after every single capture of a piece in sources (a mask of squares).
+ *
+ * @param black_turn
+ * @param sources
  * @return std::vector<BitBoard>
  */
-std::vector<BitBoard> BitBoard::captures(const bool black_turn, const unsigned int x, const unsigned int y) const {
-    auto candidates = get_candidate_locations(x, y);
+std::vector<BitBoard> BitBoard::captures_from(const bool black_turn, const uint32_t sources) const {
+    const uint32_t own = (black_turn ? this->black_is_in : this->white_is_in) & sources;
+    const uint32_t other = black_turn ? this->white_is_in : this->black_is_in;
+    const uint32_t empty = this->empty();
     std::vector<BitBoard> capture_positions;
 
-    for (auto dest : candidates) {
-        if (this->legal_capture(black_turn, x, y, dest.first, dest.second)) {
-            auto new_position = this->capture(x, y, dest.first, dest.second);
-            capture_positions.push_back(new_position);
+    for (unsigned int d = 0; d < NUM_DIAGONALS; d++) {
+        const uint32_t pieces = is_forward(black_turn, d) ? own : own & this->kings;
+        const auto back = DIAGONALS[NUM_DIAGONALS - 1 - d];
+
+        for (uint32_t jumpers = pieces & back(other & back(empty)); jumpers; jumpers &= jumpers - 1) {
+            const uint32_t source = jumpers & -jumpers;
+            const uint32_t captured = DIAGONALS[d](source);
+            capture_positions.push_back(this->jump(black_turn, source, captured, DIAGONALS[d](captured)));
         }
     }
 
@@ -294,20 +724,23 @@ std::vector<BitBoard> BitBoard::captures(const bool black_turn, const unsigned i
 }
 
 /**
- * @brief returns all possible non-capture moves from (x, y), assumes that there are no captures in the position
+ * @brief returns the positions after every non-capture move of a piece in sources (a mask of squares).
  *
  * @param black_turn
- * @param x
- * @param y
+ * @param sources
  * @return std::vector<BitBoard>
  */
-std::vector<BitBoard> BitBoard::moves(const bool black_turn, const unsigned int x, const unsigned int y) const {
-    auto candidates = get_candidate_locations(x, y);
+std::vector<BitBoard> BitBoard::moves_from(const bool black_turn, const uint32_t sources) const {
+    const uint32_t own = (black_turn ? this->black_is_in : this->white_is_in) & sources;
+    const uint32_t empty = this->empty();
     std::vector<BitBoard> moves;
 
-    for (auto dest : candidates) {
-        if (this->legal_move(black_turn, x, y, dest.first, dest.second)) {
-            moves.push_back(this->move(x, y, dest.first, dest.second));
+    for (unsigned int d = 0; d < NUM_DIAGONALS; d++) {
+        const uint32_t pieces = is_forward(black_turn, d) ? own : own & this->kings;
+
+        for (uint32_t movers = pieces & DIAGONALS[NUM_DIAGONALS - 1 - d](empty); movers; movers &= movers - 1) {
+            const uint32_t source = movers & -movers;
+            moves.push_back(this->step(black_turn, source, DIAGONALS[d](source)));
         }
     }
 
@@ -315,22 +748,64 @@ std::vector<BitBoard> BitBoard::moves(const bool black_turn, const unsigned int
 }
 
 /**
- * @brief returns all the captures available on the board.
+ * @brief returns the positions a step of black_turn leads to this board from, steps that crowned a man are left out.
+ * the steps are not checked to be legal, black_turn may have had a capture instead. used to go back a move in retrograde analysis.
  *
  * @param black_turn
  * @return std::vector<BitBoard>
  */
-std::vector<BitBoard> BitBoard::captures(const bool black_turn) const {
-    std::vector<BitBoard> result;
-
-    // generate all captures.
-    for (auto [x, y] : *this) {
-        auto new_moves = this->captures(black_turn, x, y);
-        result.reserve(result.size() + new_moves.size());
-        result.insert(result.end(), new_moves.begin(), new_moves.end());
+std::vector<BitBoard> BitBoard::steps_back(const bool black_turn) const {
+    const uint32_t own = black_turn ? this->black_is_in : this->white_is_in;
+    const uint32_t empty = this->empty();
+    std::vector<BitBoard> previous;
+
+    for (unsigned int d = 0; d < NUM_DIAGONALS; d++) {
+        const uint32_t pieces = is_forward(black_turn, d) ? own : own & this->kings;
+
+        // a piece that stepped in direction d came from the square one step back, which is empty now.
+        for (uint32_t arrived = pieces & DIAGONALS[d](empty); arrived; arrived &= arrived - 1) {
+            const uint32_t dest = arrived & -arrived;
+            const uint32_t moved = dest | DIAGONALS[NUM_DIAGONALS - 1 - d](dest);
+            const uint32_t kings = this->kings & dest ? this->kings ^ moved : this->kings;
+            previous.push_back(black_turn ? BitBoard(this->black_is_in ^ moved, this->white_is_in, kings) : BitBoard(this->black_is_in, this->white_is_in ^ moved, kings));
+        }
     }
 
-    return result;
+    return previous;
+}
+
+/**
+ * @brief returns all the legal captures from coordinates (x, y) given that is is blacks turn if black_turn.
+ *
+ * @param black_turn
+ * @param x
+ * @param y
+ * @return std::vector<BitBoard>
+ */
+std::vector<BitBoard> BitBoard::captures(const bool black_turn, const unsigned int x, const unsigned int y) const {
+    return this->captures_from(black_turn, 1U << get_board_index(x, y));
+}
+
+/**
+ * @brief returns all possible non-capture moves from (x, y), assumes that there are no captures in the position
+ *
+ * @param black_turn
+ * @param x
+ * @param y
+ * @return std::vector<BitBoard>
+ */
+std::vector<BitBoard> BitBoard::moves(const bool black_turn, const unsigned int x, const unsigned int y) const {
+    return this->moves_from(black_turn, 1U << get_board_index(x, y));
+}
+
+/**
+ * @brief returns all the captures available on the board.
+ *
+ * @param black_turn
+ * @return std::vector<BitBoard>
+ */
+std::vector<BitBoard> BitBoard::captures(const bool black_turn) const {
+    return this->captures_from(black_turn, ~0U);
 }
 
 /**
@@ -346,14 +821,117 @@ std::vector<BitBoard> BitBoard::moves(const bool black_turn) const {
     if (result.size() > 0)
         return result;
 
-    // generate all moves.
-    for (auto [x, y] : *this) {
-        auto new_moves = this->moves(black_turn, x, y);
-        result.reserve(result.size() + new_moves.size());
-        result.insert(result.end(), new_moves.begin(), new_moves.end());
+    return this->moves_from(black_turn, ~0U);
+}
+
+/**
+ * @brief sets result to every legal move, a series of captures counts as a single move.
+ * returns true if the moves are captures.
+ *
+ * @param black_turn
+ * @param result
+ * @return true
+ * @return false
+ */
+bool BitBoard::generate(const bool black_turn, MoveList& result) const {
+    result.clear();
+
+    for (uint32_t sources = this->jumpers(black_turn); sources; sources &= sources - 1) {
+        const uint32_t source = sources & -sources;
+        this->jump_sequences(black_turn, Move{ 0, 0, (uint8_t)std::countr_zero(source), 0, false }, source, result);
     }
 
-    return result;
+    if (!result.empty())
+        return true;
+
+    const uint32_t own = black_turn ? this->black_is_in : this->white_is_in;
+    const uint32_t empty = this->empty();
+    for (unsigned int d = 0; d < NUM_DIAGONALS; d++) {
+        const bool forward = is_forward(black_turn, d);
+        const uint32_t pieces = forward ? own : own & this->kings;
+
+        for (uint32_t movers = pieces & DIAGONALS[NUM_DIAGONALS - 1 - d](empty); movers; movers &= movers - 1) {
+            const uint32_t source = movers & -movers;
+            const uint32_t dest = DIAGONALS[d](source);
+            const bool promotion = forward && !(this->kings & source) && (dest & (BLACK_PROMOTION_ROW | WHITE_PROMOTION_ROW));
+            result.push_back(Move{ 0, 0, (uint8_t)std::countr_zero(source), (uint8_t)std::countr_zero(dest), promotion });
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief the position after move was played, assumes move is legal in this position.
+ *
+ * @param black_turn
+ * @param move
+ * @return BitBoard
+ */
+BitBoard BitBoard::play(const bool black_turn, const Move& move) const {
+    BitBoard end_position(*this);
+    end_position.make(black_turn, move);
+    return end_position;
+}
+
+/**
+ * @brief plays move on this board, assumes move is legal in this position.
+ *
+ * @param black_turn
+ * @param move
+ */
+void BitBoard::make(const bool black_turn, const Move& move) {
+    uint32_t& own = black_turn ? this->black_is_in : this->white_is_in;
+    uint32_t& other = black_turn ? this->white_is_in : this->black_is_in;
+    const uint32_t source = 1U << move.from;
+    const uint32_t dest = 1U << move.to;
+    const bool was_king = this->kings & source;
+
+    this->remove_piece(black_turn, was_king, move.from);
+    this->add_piece(black_turn, was_king || move.promotion, move.to);
+    for (uint32_t captured = move.captured; captured; captured &= captured - 1) {
+        const uint32_t bit = captured & -captured;
+        this->remove_piece(!black_turn, move.captured_kings & bit, std::countr_zero(bit));
+    }
+
+    // a king may end a series of captures on the square it started from.
+    own &= ~source;
+    own |= dest;
+    other &= ~move.captured;
+    this->kings &= ~(source | move.captured);
+    if (was_king || move.promotion)
+        this->kings |= dest;
+}
+
+/**
+ * @brief takes back move, which must be the last move made on this board.
+ *
+ * @param black_turn the side that played move.
+ * @param move
+ */
+void BitBoard::unmake(const bool black_turn, const Move& move) {
+    uint32_t& own = black_turn ? this->black_is_in : this->white_is_in;
+    uint32_t& other = black_turn ? this->white_is_in : this->black_is_in;
+    const uint32_t source = 1U << move.from;
+    const uint32_t dest = 1U << move.to;
+    // after the move the piece is a king, it already was one unless the move crowned it.
+    const bool was_king = !move.promotion && (this->kings & dest);
+
+    // the changes of make in reverse.
+    this->remove_piece(black_turn, was_king || move.promotion, move.to);
+    this->add_piece(black_turn, was_king, move.from);
+    for (uint32_t captured = move.captured; captured; captured &= captured - 1) {
+        const uint32_t bit = captured & -captured;
+        this->add_piece(!black_turn, move.captured_kings & bit, std::countr_zero(bit));
+    }
+
+    own &= ~dest;
+    own |= source;
+    other |= move.captured;
+    this->kings &= ~dest;
+    this->kings |= move.captured_kings;
+    if (was_king)
+        this->kings |= source;
 }
 
 /**
@@ -387,39 +965,40 @@ Piece BitBoard::get(const unsigned int x, const unsigned int y) const {
  * @param value
  */
 void BitBoard::set(const unsigned int x, const unsigned int y, const Piece value) {
-    int index = get_board_index(x, y);
+    const unsigned int index = get_board_index(x, y);
+    const uint32_t bit = 1U << index;
+
+    if ((this->black_is_in | this->white_is_in) & bit)
+        this->remove_piece(this->black_is_in & bit, this->kings & bit, index);
+    if (value != Piece::NONE)
+        this->add_piece(value == Piece::BLACK || value == Piece::BLACK_KING, value == Piece::BLACK_KING || value == Piece::WHITE_KING, index);
+
+    this->black_is_in &= ~bit;
+    this->white_is_in &= ~bit;
+    this->kings &= ~bit;
 
     switch (value) {
     case Piece::NONE:
-        this->black_is_in[index] = false;
-        this->white_is_in[index] = false;
-        this->kings[index] = false;
         break;
     case Piece::WHITE:
-        this->black_is_in[index] = false;
-        this->white_is_in[index] = true;
-        this->kings[index] = false;
+        this->white_is_in |= bit;
         break;
     case Piece::BLACK:
-        this->black_is_in[index] = true;
-        this->white_is_in[index] = false;
-        this->kings[index] = false;
+        this->black_is_in |= bit;
         break;
     case Piece::WHITE_KING:
-        this->black_is_in[index] = false;
-        this->white_is_in[index] = true;
-        this->kings[index] = true;
+        this->white_is_in |= bit;
+        this->kings |= bit;
         break;
     case Piece::BLACK_KING:
-        this->black_is_in[index] = true;
-        this->white_is_in[index] = false;
-        this->kings[index] = true;
+        this->black_is_in |= bit;
+        this->kings |= bit;
         break;
     }
 }
 
 BitBoard::Iterator::Iterator(const unsigned int index, const BitBoard& board) : index(index), board(board) {
-    if (!board.white_is_in[this->index] && !board.black_is_in[this->index])
+    if (this->index < NUMBER_OF_REACHABLE_SQUARES && !this->occupied())
         this->skip_to_next();
 }
 
@@ -465,16 +1044,20 @@ bool BitBoard::Iterator::operator!=(const Iterator& other) const {
     return this->index != other.index;
 }
 
+bool BitBoard::Iterator::occupied() const {
+    return ((this->board.black_is_in | this->board.white_is_in) >> this->index) & 1U;
+}
+
 void BitBoard::Iterator::skip_to_next() {
     this->index++;
-    for (; this->index < NUMBER_OF_REACHABLE_SQUARES && !this->board.black_is_in[this->index] && !this->board.white_is_in[this->index]; this->index++);
+    for (; this->index < NUMBER_OF_REACHABLE_SQUARES && !this->occupied(); this->index++);
 }
 
 void BitBoard::Iterator::skip_to_pre() {
     if (0 == this->index)
         return;
     this->index--;
-    for (; 0 < this->index && !this->board.black_is_in[this->index] && !this->board.white_is_in[this->index]; this->index--);
+    for (; 0 < this->index && !this->occupied(); this->index--);
 }
 
 std::stringstream& operator<<(std::stringstream& strm, Piece piece) {
@@ -5,26 +5,43 @@
 #include <bitset>
 #include <iomanip>
 #include "consts.hpp"
+#include "move.hpp"
 #include <tuple>
 #include <vector>
 #include <algorithm>
-#include <boost/functional/hash.hpp>
 #include <sstream>
+#include <cstdint>
+#include <bit>
 
 class BitBoard {
 private:
-    // 4293918720ULL => the number that in the bitboard represents all the starting black squares.
-    std::bitset<NUMBER_OF_REACHABLE_SQUARES> black_is_in = { 4293918720ULL };
-    // 4095ULL => the number that in the bitboard represents all the starting white squares.
-    std::bitset<NUMBER_OF_REACHABLE_SQUARES> white_is_in = { 4095ULL };
-    std::bitset<NUMBER_OF_REACHABLE_SQUARES> kings = { 0ULL };
-
+    // 4293918720U => the number that in the bitboard represents all the starting black squares.
+    uint32_t black_is_in = 4293918720U;
+    // 4095U => the number that in the bitboard represents all the starting white squares.
+    uint32_t white_is_in = 4095U;
+    uint32_t kings = 0U;
+    // zobrist key of the pieces, kept up to date by every change of the board.
+    uint64_t key;
+    // static evaluation of the pieces, positive is good for white, kept up to date by every change of the board.
+    short score;
+
+    uint64_t compute_key() const;
+    void add_piece(const bool black, const bool king, const unsigned int index);
+    void remove_piece(const bool black, const bool king, const unsigned int index);
     void set_king(const unsigned int x, const unsigned int y);
     void set(const unsigned int x, const unsigned int y, const Piece value);
 
+    BitBoard step(const bool black_turn, const uint32_t source, const uint32_t dest) const;
+    BitBoard jump(const bool black_turn, const uint32_t source, const uint32_t captured, const uint32_t dest) const;
+    void jump_sequences(const bool black_turn, Move move, const uint32_t source, MoveList& result) const;
+    std::vector<BitBoard> captures_from(const bool black_turn, const uint32_t sources) const;
+    std::vector<BitBoard> moves_from(const bool black_turn, const uint32_t sources) const;
+
 public:
     BitBoard();
     BitBoard(const BitBoard& other);
+    BitBoard(const uint32_t black, const uint32_t white, const uint32_t kings);
+    static bool valid(const uint32_t black, const uint32_t white, const uint32_t kings);
 
     Piece get(const unsigned int x, const unsigned int y) const;
 
@@ -36,6 +53,10 @@ public:
     bool is_king(const std::pair<const unsigned int, const unsigned int> coords) const;
     void set_king(const std::pair<const unsigned int, const unsigned int> coords);
 
+    uint64_t hash(const bool black_turn) const;
+    short evaluation() const;
+    short compute_score() const;
+
     short num_white() const;
     short num_black() const;
     short piece_count() const;
@@ -54,6 +75,18 @@ public:
 
     std::vector<BitBoard> captures(const bool black_turn) const;
     std::vector<BitBoard> moves(const bool black_turn) const;
+    std::vector<BitBoard> steps_back(const bool black_turn) const;
+
+    uint32_t empty() const;
+    uint32_t black_pieces() const;
+    uint32_t white_pieces() const;
+    uint32_t king_pieces() const;
+    uint32_t movers(const bool black_turn) const;
+    uint32_t jumpers(const bool black_turn) const;
+    bool generate(const bool black_turn, MoveList& result) const;
+    BitBoard play(const bool black_turn, const Move& move) const;
+    void make(const bool black_turn, const Move& move);
+    void unmake(const bool black_turn, const Move& move);
 
     std::bitset<NUMBER_OF_REACHABLE_SQUARES> operator^(const BitBoard& other) const;
     std::bitset<NUMBER_OF_REACHABLE_SQUARES> operator&(const BitBoard& other) const;
@@ -69,6 +102,7 @@ public:
         const BitBoard& board;
         void skip_to_next();
         void skip_to_pre();
+        bool occupied() const;
     public:
         Iterator(const unsigned int index, const BitBoard& board);
         Iterator& operator++();
@@ -97,6 +131,8 @@ std::stringstream& operator<<(std::stringstream& strm, Piece piece);
 std::ostream& operator<<(std::ostream& strm, const BitBoard& board);
 std::ostream& operator<<(std::ostream& strm, Piece piece);
 bool in_bounds(const unsigned int index);
+std::pair<unsigned int, unsigned int> board_index_to_xy(const unsigned int index);
+std::vector<unsigned int> move_squares(const Move& move);
 
 #include "helpFuncs.hpp"
 
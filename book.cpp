@@ -0,0 +1,138 @@
+#include "book.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+bool BookEntry::operator<(const BookEntry& other) const {
+    return this->key < other.key;
+}
+
+OpeningBook::OpeningBook() : entries(nullptr), count(0), length(0), mapping(nullptr) {}
+
+OpeningBook::~OpeningBook() {
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->length);
+}
+
+/**
+ * @brief maps the book file at path, returns false if it is not a complete book file.
+ *
+ * @param path
+ * @return true
+ * @return false
+ */
+bool OpeningBook::load(const std::string& path) {
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    if (fstat(file, &status) == 0 && (std::size_t)status.st_size >= sizeof(BookHeader))
+        mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    // the mapping stays valid after the file is closed.
+    close(file);
+
+    if (mapping == MAP_FAILED)
+        return false;
+
+    const BookHeader* header = (const BookHeader*)mapping;
+    if (std::memcmp(header->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0 || sizeof(BookHeader) + header->count * sizeof(BookEntry) != (std::size_t)status.st_size) {
+        munmap(mapping, status.st_size);
+        return false;
+    }
+
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->length);
+    this->mapping = mapping;
+    this->length = status.st_size;
+    this->count = header->count;
+    this->entries = (const BookEntry*)(header + 1);
+
+    return true;
+}
+
+/**
+ * @brief the number of moves in the book.
+ *
+ * @return std::size_t
+ */
+std::size_t OpeningBook::size() const {
+    return this->count;
+}
+
+/**
+ * @brief picks a move for board from the book, returns false if the book has no legal move for it.
+ * every move is picked in proportion to its weight, random decides which.
+ *
+ * @param board
+ * @param black_turn
+ * @param random
+ * @param move
+ * @param score the score the move was saved with.
+ * @return true
+ * @return false
+ */
+bool OpeningBook::choose(const BitBoard& board, const bool black_turn, const uint64_t random, Move& move, short& score) const {
+    BookEntry target{};
+    target.key = board.hash(black_turn);
+    const auto [first, last] = std::equal_range(this->entries, this->entries + this->count, target);
+
+    MoveList legal;
+    board.generate(black_turn, legal);
+
+    // the key may be shared with another position, so only moves that are legal here count.
+    uint64_t total = 0;
+    for (auto entry = first; entry != last; entry++)
+        if (legal.contains(Move{ entry->captured, 0, entry->from, entry->to, false }))
+            total += entry->weight;
+    if (total == 0)
+        return false;
+
+    uint64_t pick = random % total;
+    for (auto entry = first; entry != last; entry++) {
+        const Move candidate{ entry->captured, 0, entry->from, entry->to, false };
+        if (!legal.contains(candidate))
+            continue;
+        if (pick < entry->weight) {
+            move = *std::find(legal.begin(), legal.end(), candidate);
+            score = entry->score;
+            return true;
+        }
+        pick -= entry->weight;
+    }
+
+    return false;
+}
+
+/**
+ * @brief writes a book file with entries to path, the file only gets its name once it is complete.
+ *
+ * @param path
+ * @param entries
+ * @return true
+ * @return false
+ */
+bool OpeningBook::write(const std::string& path, std::vector<BookEntry> entries) {
+    std::stable_sort(entries.begin(), entries.end());
+    BookHeader header{};
+    std::memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.count = entries.size();
+
+    {
+        std::ofstream file(path + ".part", std::ios::binary | std::ios::trunc);
+        file.write((const char*)&header, sizeof(header));
+        file.write((const char*)entries.data(), entries.size() * sizeof(BookEntry));
+        if (!file)
+            return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(path + ".part", path, error);
+    return !error;
+}
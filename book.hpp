@@ -0,0 +1,61 @@
+#ifndef BOOK_HPP
+#define BOOK_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "consts.hpp"
+#include "move.hpp"
+#include "bitboard.hpp"
+
+/**
+ * @brief one move of a position in the opening book, a book file is a BookHeader followed by these sorted by key.
+ */
+struct BookEntry {
+    // zobrist key of the position with the side to move.
+    uint64_t key;
+    uint32_t captured;
+    // how often the move was played, the move is chosen in proportion to it.
+    uint16_t weight;
+    // evaluation of the move when it was searched, positive is good for white.
+    int16_t score;
+    uint8_t from;
+    uint8_t to;
+    uint8_t reserved[6];
+
+    bool operator<(const BookEntry& other) const;
+};
+
+struct BookHeader {
+    char magic[8];
+    uint64_t count;
+};
+
+// first bytes of every book file.
+constexpr char BOOK_MAGIC[8] = { 'C', 'K', 'R', 'S', 'B', 'O', 'O', 'K' };
+
+/**
+ * @brief read only access to an opening book file, the file is memory mapped so every process playing from it shares one copy.
+ */
+class OpeningBook {
+private:
+    const BookEntry* entries;
+    std::size_t count;
+    std::size_t length;
+    void* mapping;
+
+public:
+    OpeningBook();
+    ~OpeningBook();
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    bool load(const std::string& path);
+    std::size_t size() const;
+    bool choose(const BitBoard& board, const bool black_turn, const uint64_t random, Move& move, short& score) const;
+
+    static bool write(const std::string& path, std::vector<BookEntry> entries);
+};
+
+#endif // BOOK_HPP
@@ -0,0 +1,103 @@
+#include "book.hpp"
+#include "engine.hpp"
+#include <random>
+#include <unordered_map>
+#include <execution>
+
+/**
+ * @brief a move searched by the builder, and its evaluation.
+ */
+struct Candidate {
+    Move move;
+    short score;
+};
+
+/**
+ * @brief builds an opening book from self-play of the engine, every game is played up to plies plies from the starting position.
+ * every move of every position on the way is searched to depth, and one of the moves within margin of the best is played at random.
+ * the weight of a move in the book is the number of games that played it.
+ *
+ * usage: bookgen <book> <plies> <games> [depth] [margin] [seed]
+ */
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0] << " <book> <plies> <games> [depth] [margin] [seed]" << std::endl;
+        return 1;
+    }
+
+    const std::string path = argv[1];
+    const unsigned int plies = std::stoul(argv[2]);
+    const unsigned int games = std::stoul(argv[3]);
+    const unsigned int depth = argc > 4 ? std::stoul(argv[4]) : 8;
+    const short margin = argc > 5 ? std::stoi(argv[5]) : 8;
+    std::mt19937_64 random(argc > 6 ? std::stoull(argv[6]) : 1);
+
+    if (depth < 1 || depth > MAX_DEPTH) {
+        std::cerr << "depth must be between 1 and " << MAX_DEPTH << std::endl;
+        return 1;
+    }
+
+    Engine engine;
+    // the moves of every position reached so far, by its key.
+    std::unordered_map<uint64_t, std::vector<Candidate>> searched;
+    // the book entries, by the key of their position and their index in its candidates.
+    std::unordered_map<uint64_t, std::unordered_map<unsigned int, BookEntry>> played;
+
+    for (unsigned int game = 0; game < games; game++) {
+        BitBoard board;
+        bool black_turn = true;
+
+        for (unsigned int ply = 0; ply < plies; ply++) {
+            const uint64_t key = board.hash(black_turn);
+            auto [position, added] = searched.try_emplace(key);
+            std::vector<Candidate>& candidates = position->second;
+
+            if (added) {
+                MoveList moves;
+                board.generate(black_turn, moves);
+                candidates.resize(moves.size());
+                std::for_each(std::execution::par, moves.begin(), moves.end(), [&](const Move& move) {
+                    candidates[&move - moves.begin()] = Candidate{ move, engine.alpha_beta_analysis(board.play(black_turn, move), !black_turn, depth - 1) };
+                });
+            }
+
+            if (candidates.empty())
+                break;
+
+            short best = candidates.front().score;
+            for (const auto& candidate : candidates)
+                best = black_turn ? std::min(best, candidate.score) : std::max(best, candidate.score);
+
+            std::vector<unsigned int> good;
+            for (unsigned int i = 0; i < candidates.size(); i++)
+                if (std::abs(candidates[i].score - best) <= margin)
+                    good.push_back(i);
+
+            const unsigned int chosen = good[random() % good.size()];
+            const Candidate& candidate = candidates[chosen];
+            BookEntry& entry = played[key][chosen];
+            entry.key = key;
+            entry.captured = candidate.move.captured;
+            entry.from = candidate.move.from;
+            entry.to = candidate.move.to;
+            entry.score = candidate.score;
+            entry.weight = std::min<unsigned int>(entry.weight + 1, UINT16_MAX);
+
+            board = board.play(black_turn, candidate.move);
+            black_turn = !black_turn;
+        }
+    }
+
+    std::vector<BookEntry> entries;
+    for (const auto& [key, moves] : played)
+        for (const auto& [index, entry] : moves)
+            entries.push_back(entry);
+
+    if (!OpeningBook::write(path, entries)) {
+        std::cerr << "failed to write " << path << std::endl;
+        return 1;
+    }
+
+    std::cout << path << ": " << played.size() << " positions, " << entries.size() << " moves, " << searched.size() << " positions searched" << std::endl;
+    return 0;
+}
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <tuple>
+#include <cstdint>
+#include <cstddef>
 
 constexpr unsigned int NUM_ROWS = 8;
 constexpr unsigned int NUM_COLS = NUM_ROWS;
@@ -12,6 +14,45 @@ constexpr unsigned int STARTING_ROWS = 3;
 constexpr unsigned int REPETITION_DRAW = 3;
 // Number of non capture move to force a draw
 constexpr unsigned int NO_CAPTURE_DRAW = 100;
+// Capacity of a move list, more than the number of legal moves in any reachable position
+constexpr unsigned int MAX_MOVES = 128;
+// Deepest line the engine can search
+constexpr unsigned int MAX_DEPTH = 64;
+// Nodes a search thread visits between checks of the time and node limits
+constexpr unsigned int NODES_PER_CHECK = 1024;
+// Positions with at least this many plies left to search have their moves searched by several threads at once
+constexpr unsigned int MIN_SPLIT_DEPTH = 4;
+// Cutoffs by moves at this index of the move ordering or later are counted together in the search statistics
+constexpr unsigned int CUTOFF_INDICES = 8;
+// Default size of the transposition table in megabytes
+constexpr std::size_t DEFAULT_TABLE_MEGABYTES = 32;
+// Most pieces on the board of a position the endgame tablebase can hold
+constexpr unsigned int MAX_TABLEBASE_PIECES = 8;
+// Score of a tablebase win, less the plies it takes to win, far above any evaluation and below the score of a loss on the board
+constexpr short TABLEBASE_WIN = 32000;
+
+// Bit masks over the 32 reachable squares, bit index = (x >> 1) + (y << 2).
+// rows with an even y (the reachable squares are on odd x) and rows with an odd y (reachable squares on even x).
+constexpr uint32_t EVEN_ROWS = 0x0F0F0F0FU;
+constexpr uint32_t ODD_ROWS = 0xF0F0F0F0U;
+// the first and last reachable square of every row.
+constexpr uint32_t FIRST_IN_ROW = 0x11111111U;
+constexpr uint32_t LAST_IN_ROW = 0x88888888U;
+// rows a piece is promoted on: black moves up to y == 0, white moves down to y == NUM_ROWS - 1.
+constexpr uint32_t BLACK_PROMOTION_ROW = 0x0000000FU;
+constexpr uint32_t WHITE_PROMOTION_ROW = 0xF0000000U;
+// squares in the middle of the board, worth more because a piece there can impact more: (2, 3) to (6, 5).
+constexpr uint32_t CENTER_SQUARES = 0x00E6E000U;
+// squares on the sides of the board, worth more because a piece there cannot be taken.
+constexpr uint32_t EDGE_SQUARES = (FIRST_IN_ROW & ODD_ROWS) | (LAST_IN_ROW & EVEN_ROWS) | BLACK_PROMOTION_ROW | WHITE_PROMOTION_ROW;
+// the two corners are on two sides of the board, and count for each of them.
+constexpr uint32_t CORNER_SQUARES = (FIRST_IN_ROW & ODD_ROWS & WHITE_PROMOTION_ROW) | (LAST_IN_ROW & EVEN_ROWS & BLACK_PROMOTION_ROW);
+// what a piece adds to the evaluation: material is worth the most, then being in the center, then being on a side.
+constexpr short MAN_VALUE = 64;
+constexpr short KING_VALUE = 96;
+constexpr short CENTER_VALUE = 2;
+constexpr short EDGE_VALUE = 1;
+constexpr short CORNER_VALUE = 1;
 
 enum class Piece {
     NONE = 0,
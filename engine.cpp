@@ -1,346 +1,1072 @@
 #include "engine.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
-TreeNode::TreeNode(const BitBoard state, TreeNode* father, short eval) :
-    board{ state }, father{ father }, eval{ eval }, children{ std::vector<TreeNode>() } {}
+std::size_t hash_position::operator()(const Position& position) const {
+    return position.first.hash(position.second);
+}
 
-TreeNode::TreeNode(const TreeNode& other) : TreeNode(other.board, other.father, other.eval) {}
+/**
+ * @brief evaluate a position without looking at any depth of it.
+ * the board keeps its evaluation up to date as pieces move, so this only reads it.
+ *
+ * @param board
+ * @return short
+ */
+short evaluate(const BitBoard& board) {
+    return board.evaluation();
+}
 
-bool TreeNode::operator<(const TreeNode& other) const {
-    return this->eval < other.eval;
+/**
+ * @brief evaluates count boards from scratch one at a time, for cpus without vector instructions and for the boards left over by the vector kernels.
+ *
+ * @param boards
+ * @param count
+ * @param evals
+ */
+void evaluate_scalar(const BitBoard* boards, const std::size_t count, short* evals) {
+    for (std::size_t i = 0; i < count; i++)
+        evals[i] = boards[i].compute_score();
 }
 
-TreeNode& TreeNode::operator=(TreeNode&& other) {
-    this->children = std::move(other.children);
-    this->eval = other.eval;
-    this->father = other.father;
-    other.eval = 0;
-    other.father = nullptr;
-    this->board = other.board;
-    return *this;
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * @brief popcount of every 32 bit lane of words, counted a nibble at a time with a table lookup.
+ *
+ * @param words
+ * @return __m128i
+ */
+__attribute__((target("ssse3,sse4.1"))) inline __m128i popcount_lanes(const __m128i words) {
+    const __m128i table = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i bytes = _mm_add_epi8(_mm_shuffle_epi8(table, _mm_and_si128(words, nibble)),
+        _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(words, 4), nibble)));
+    // the sum of the 4 byte counts of a lane ends up in its top byte.
+    return _mm_srli_epi32(_mm_mullo_epi32(bytes, _mm_set1_epi32(0x01010101)), 24);
 }
 
-TreeNode& TreeNode::operator=(const TreeNode& other) {
-    this->children = other.children;
-    this->eval = other.eval;
-    this->father = other.father;
-    this->board = other.board;
-    return *this;
+/**
+ * @brief the difference of the white and black piece counts over mask in every 32 bit lane.
+ *
+ * @param white
+ * @param black
+ * @param mask
+ * @return __m128i
+ */
+__attribute__((target("ssse3,sse4.1"))) inline __m128i balance_lanes(const __m128i white, const __m128i black, const __m128i mask) {
+    return _mm_sub_epi32(popcount_lanes(_mm_and_si128(white, mask)), popcount_lanes(_mm_and_si128(black, mask)));
 }
 
-std::size_t hash_position::operator()(const Position& position) const {
-    std::size_t seed = 0;
-    boost::hash_combine(seed, BitBoard::hasher()(position.first));
-    boost::hash_combine(seed, position.second);
-    return seed;
+/**
+ * @brief evaluates 4 boards at a time with SSE, the same evaluation as evaluate_scalar.
+ *
+ * @param boards
+ * @param count
+ * @param evals
+ */
+__attribute__((target("ssse3,sse4.1"))) void evaluate_sse(const BitBoard* boards, const std::size_t count, short* evals) {
+    constexpr std::size_t LANES = 4;
+    std::size_t i = 0;
+
+    for (; i + LANES <= count; i += LANES) {
+        alignas(16) uint32_t white[LANES], black[LANES], kings[LANES];
+        alignas(16) int32_t result[LANES];
+        for (std::size_t lane = 0; lane < LANES; lane++) {
+            white[lane] = boards[i + lane].white_pieces();
+            black[lane] = boards[i + lane].black_pieces();
+            kings[lane] = boards[i + lane].king_pieces();
+        }
+
+        const __m128i w = _mm_load_si128((const __m128i*)white);
+        const __m128i b = _mm_load_si128((const __m128i*)black);
+        const __m128i k = _mm_load_si128((const __m128i*)kings);
+        const __m128i men = _mm_andnot_si128(k, _mm_set1_epi32(-1));
+        __m128i eval = _mm_add_epi32(_mm_mullo_epi32(balance_lanes(w, b, men), _mm_set1_epi32(MAN_VALUE)),
+            _mm_mullo_epi32(balance_lanes(w, b, k), _mm_set1_epi32(KING_VALUE)));
+        eval = _mm_add_epi32(eval, _mm_mullo_epi32(balance_lanes(w, b, _mm_set1_epi32(CENTER_SQUARES)), _mm_set1_epi32(CENTER_VALUE)));
+        eval = _mm_add_epi32(eval, _mm_mullo_epi32(balance_lanes(w, b, _mm_set1_epi32(EDGE_SQUARES)), _mm_set1_epi32(EDGE_VALUE)));
+        eval = _mm_add_epi32(eval, _mm_mullo_epi32(balance_lanes(w, b, _mm_set1_epi32(CORNER_SQUARES)), _mm_set1_epi32(CORNER_VALUE)));
+
+        _mm_store_si128((__m128i*)result, eval);
+        for (std::size_t lane = 0; lane < LANES; lane++)
+            evals[i + lane] = result[lane];
+    }
+
+    evaluate_scalar(boards + i, count - i, evals + i);
 }
 
 /**
- * @brief sets node's children to all the possible next position from it assuming it's black's turn is black_turn.
- * returns true is there was a capture.
+ * @brief popcount of every 32 bit lane of words, counted a nibble at a time with a table lookup.
  *
- * @param black_turn
+ * @param words
+ * @return __m256i
+ */
+__attribute__((target("avx2"))) inline __m256i popcount_lanes(const __m256i words) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(words, nibble)),
+        _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(words, 4), nibble)));
+    // the sum of the 4 byte counts of a lane ends up in its top byte.
+    return _mm256_srli_epi32(_mm256_mullo_epi32(bytes, _mm256_set1_epi32(0x01010101)), 24);
+}
+
+/**
+ * @brief the difference of the white and black piece counts over mask in every 32 bit lane.
+ *
+ * @param white
+ * @param black
+ * @param mask
+ * @return __m256i
+ */
+__attribute__((target("avx2"))) inline __m256i balance_lanes(const __m256i white, const __m256i black, const __m256i mask) {
+    return _mm256_sub_epi32(popcount_lanes(_mm256_and_si256(white, mask)), popcount_lanes(_mm256_and_si256(black, mask)));
+}
+
+/**
+ * @brief evaluates 8 boards at a time with AVX2, the same evaluation as evaluate_scalar.
+ *
+ * @param boards
+ * @param count
+ * @param evals
+ */
+__attribute__((target("avx2"))) void evaluate_avx2(const BitBoard* boards, const std::size_t count, short* evals) {
+    constexpr std::size_t LANES = 8;
+    std::size_t i = 0;
+
+    for (; i + LANES <= count; i += LANES) {
+        alignas(32) uint32_t white[LANES], black[LANES], kings[LANES];
+        alignas(32) int32_t result[LANES];
+        for (std::size_t lane = 0; lane < LANES; lane++) {
+            white[lane] = boards[i + lane].white_pieces();
+            black[lane] = boards[i + lane].black_pieces();
+            kings[lane] = boards[i + lane].king_pieces();
+        }
+
+        const __m256i w = _mm256_load_si256((const __m256i*)white);
+        const __m256i b = _mm256_load_si256((const __m256i*)black);
+        const __m256i k = _mm256_load_si256((const __m256i*)kings);
+        const __m256i men = _mm256_andnot_si256(k, _mm256_set1_epi32(-1));
+        __m256i eval = _mm256_add_epi32(_mm256_mullo_epi32(balance_lanes(w, b, men), _mm256_set1_epi32(MAN_VALUE)),
+            _mm256_mullo_epi32(balance_lanes(w, b, k), _mm256_set1_epi32(KING_VALUE)));
+        eval = _mm256_add_epi32(eval, _mm256_mullo_epi32(balance_lanes(w, b, _mm256_set1_epi32(CENTER_SQUARES)), _mm256_set1_epi32(CENTER_VALUE)));
+        eval = _mm256_add_epi32(eval, _mm256_mullo_epi32(balance_lanes(w, b, _mm256_set1_epi32(EDGE_SQUARES)), _mm256_set1_epi32(EDGE_VALUE)));
+        eval = _mm256_add_epi32(eval, _mm256_mullo_epi32(balance_lanes(w, b, _mm256_set1_epi32(CORNER_SQUARES)), _mm256_set1_epi32(CORNER_VALUE)));
+
+        _mm256_store_si256((__m256i*)result, eval);
+        for (std::size_t lane = 0; lane < LANES; lane++)
+            evals[i + lane] = result[lane];
+    }
+
+    evaluate_sse(boards + i, count - i, evals + i);
+}
+
+#endif
+
+typedef void (*BatchEvaluator)(const BitBoard*, const std::size_t, short*);
+
+/**
+ * @brief the widest batch evaluation the cpu running the program supports.
+ *
+ * @return BatchEvaluator
+ */
+BatchEvaluator choose_batch_evaluator() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return evaluate_avx2;
+    if (__builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1"))
+        return evaluate_sse;
+#endif
+    return evaluate_scalar;
+}
+
+/**
+ * @brief evaluates count boards from scratch together into evals, the same as evaluate on each of them.
+ * for many unrelated boards, which have no evaluation kept up to date by a search, the boards are evaluated several at a time with vector instructions,
+ * the widest kind the cpu has is chosen once at runtime.
+ *
+ * @param boards
+ * @param count
+ * @param evals
+ */
+void evaluate(const BitBoard* boards, const std::size_t count, short* evals) {
+    static const BatchEvaluator evaluator = choose_batch_evaluator();
+    evaluator(boards, count, evals);
+}
+
+Engine::Engine(const std::size_t table_megabytes, const unsigned int threads, const ParallelMode mode) :
+    position_history(std::unordered_map<const Position, unsigned int, hash_position>()), since_capture(0), table(table_megabytes), mode(mode),
+    random(std::random_device()()), last_position(), last_result{ BitBoard(), 0, 0 }, ponder_control(nullptr), ponder_stopped(false), ponder_limits{ 0, 0, 0 } {
+    this->set_threads(threads);
+}
+
+Engine::~Engine() {
+    this->stop_pondering();
+}
+
+unsigned int Engine::increment_position_history_counter(const Position& position) {
+    this->stop_pondering();
+    this->forget_last_search();
+    return ++this->position_history[position];
+}
+
+void Engine::increment_since_capture() {
+    this->stop_pondering();
+    this->forget_last_search();
+    this->since_capture++;
+}
+
+void Engine::reset_since_capture() {
+    this->stop_pondering();
+    this->forget_last_search();
+    this->since_capture = 0;
+}
+
+/**
+ * @brief the result of the last search no longer applies once the game moved on, the same position may then be a repetition.
+ */
+void Engine::forget_last_search() {
+    this->last_result.depth = 0;
+}
+
+unsigned int Engine::get_since_capture() {
+    return this->since_capture;
+}
+
+/**
+ * @brief reallocates the transposition table to megabytes, forgets everything that was searched so far.
+ *
+ * @param megabytes
+ */
+void Engine::set_table_size(const std::size_t megabytes) {
+    this->stop_pondering();
+    this->table.resize(megabytes);
+}
+
+/**
+ * @brief sets the number of threads searching for the engine, 0 => one per hardware thread.
+ *
+ * @param threads
+ */
+void Engine::set_threads(const unsigned int threads) {
+    this->stop_pondering();
+    this->threads = threads != 0 ? threads : std::max(std::thread::hardware_concurrency(), 1U);
+    this->arena.terminate();
+    this->arena.initialize(this->threads);
+}
+
+unsigned int Engine::get_threads() const {
+    return this->threads;
+}
+
+void Engine::set_parallel_mode(const ParallelMode mode) {
+    this->stop_pondering();
+    this->mode = mode;
+}
+
+/**
+ * @brief maps the endgame tablebase files in directory, the search then looks up the positions they hold instead of searching them.
+ * returns the number of files found, if there are none the engine keeps the tablebase it had.
+ *
+ * @param directory
+ * @return unsigned int
+ */
+unsigned int Engine::load_tablebase(const std::string& directory) {
+    auto tablebase = std::make_unique<Tablebase>();
+    const unsigned int loaded = tablebase->load(directory);
+
+    if (loaded != 0) {
+        this->stop_pondering();
+        this->forget_last_search();
+        this->tablebase = std::move(tablebase);
+    }
+    return loaded;
+}
+
+/**
+ * @brief maps the opening book file at path, best_move then plays the positions it holds from it without searching.
+ * returns false if there is no book at path, the engine then keeps the book it had.
+ *
+ * @param path
  * @return true
  * @return false
  */
-bool TreeNode::expand(bool black_turn) {
-    this->children.clear();
-    // for each coordinate non-empty on the board
-    for (auto [x, y] : this->board) {
-        // if the piece is of the wrong color: skip it.
-        if (black_turn && !this->board.is_black(x, y))
-            continue;
-        if (!black_turn && !this->board.is_white(x, y))
-            continue;
+bool Engine::load_book(const std::string& path) {
+    auto book = std::make_unique<OpeningBook>();
+    if (!book->load(path))
+        return false;
 
-        // reached_jumps: boards we have just reached.
-        std::vector<BitBoard> reached_jumps = { this->board };
-        // will keep track in correspondence to reaches_jumps of the last coordinate we jumped to.
-        std::vector<std::pair<unsigned int, unsigned int>> jump_coords = { {x, y} };
-
-        // while we jumped somewhere new:
-        while (jump_coords.size() != 0) {
-            // next iterations of previously explained vectors.
-            std::vector<BitBoard> new_reached_jumps;
-            std::vector<std::pair<unsigned int, unsigned int>> new_coords_jumps;
-
-            // for each last coordinate and position:
-            for (auto [jump_coords, current_position] : boost::combine(jump_coords, reached_jumps)) {
-                auto [source_x, source_y] = jump_coords;
-                auto candidates = get_candidate_locations(source_x, source_y);
-
-                // try ro jump from it, add new jumps to new_reaches_jumps and new_coords_jumps.
-                bool captured = false;
-                for (auto [capture_x, capture_y] : candidates) {
-                    if (current_position.legal_capture(black_turn, source_x, source_y, capture_x, capture_y)) {
-                        new_reached_jumps.push_back(current_position.capture(source_x, source_y, capture_x, capture_y));
-                        new_coords_jumps.push_back(get_end_capture_pos(source_x, source_y, capture_x, capture_y));
-                        captured = true;
-                    }
-                }
+    this->stop_pondering();
+    this->forget_last_search();
+    this->book = std::move(book);
+    return true;
+}
 
-                // if no new reached jumps <=> captured == false which means add this to the children of the node.
-                if (!captured && current_position != this->board)
-                    this->children.emplace_back(current_position, this);
-            }
+/**
+ * @brief starts searching in the background while the opponent thinks on board, where black_turn is the opponent.
+ * the position after the reply the engine expects is searched first, then the positions after the other replies, each within limits as a move of the engine would be.
+ * once the opponent replied, pondered_move hands out the best move if its position was searched, and otherwise the search starts from a warm table.
+ * anything that changes the engine or its game stops the pondering first, best_move does not so pondered_move or stop_pondering come before it.
+ *
+ * @param board
+ * @param black_turn
+ * @param limits
+ */
+void Engine::ponder(const BitBoard& board, const bool black_turn, const SearchLimits& limits) {
+    this->stop_pondering();
+    this->pondered.clear();
+    // a reply gets what a move of the engine gets, without its time and nodes a search limited by them would go on to MAX_DEPTH.
+    const SearchLimits pondering{ std::clamp(limits.depth, 1U, MAX_DEPTH), limits.time, limits.nodes };
+    this->ponder_limits = pondering;
+    this->ponder_stopped = false;
+    this->ponderer = std::thread([this, board, black_turn, pondering]() { this->ponder_replies(board, black_turn, pondering); });
+}
 
-            reached_jumps = std::move(new_reached_jumps);
-            jump_coords = std::move(new_coords_jumps);
-        }
+/**
+ * @brief stops the pondering and waits for it, what it finished searching is kept for pondered_move.
+ */
+void Engine::stop_pondering() {
+    if (!this->ponderer.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(this->ponder_lock);
+        this->ponder_stopped = true;
+        if (this->ponder_control != nullptr)
+            this->ponder_control->stop();
     }
+    this->ponderer.join();
+}
 
-    // if found jumps
-    if (this->children.size() != 0)
-        return true;
+/**
+ * @brief stops the pondering, and sets result to the best move of board if pondering searched it with the same limits or to at least their depth.
+ *
+ * @param board
+ * @param black_turn
+ * @param limits
+ * @param result
+ * @return true
+ * @return false
+ */
+bool Engine::pondered_move(const BitBoard& board, const bool black_turn, const SearchLimits& limits, SearchResult& result) {
+    this->stop_pondering();
+
+    const auto found = this->pondered.find(Position(board, black_turn));
+    if (found == this->pondered.end())
+        return false;
 
-    // look for regular moves.
-    for (auto [x, y] : this->board) {
-        auto new_moves = this->board.moves(black_turn, x, y);
-        this->children.reserve(this->children.size() + new_moves.size());
+    const unsigned int depth = std::clamp(limits.depth, 1U, MAX_DEPTH);
+    const bool same = depth == this->ponder_limits.depth && limits.time == this->ponder_limits.time && limits.nodes == this->ponder_limits.nodes;
+    if (!same && found->second.depth < depth)
+        return false;
 
-        for (auto& new_move : new_moves) {
-            this->children.emplace_back(new_move, this);
+    result = found->second;
+    return true;
+}
+
+/**
+ * @brief the work of the pondering thread: searches the position after every reply of black_turn on board, the expected reply first.
+ *
+ * @param board
+ * @param black_turn the opponent.
+ * @param limits
+ */
+void Engine::ponder_replies(const BitBoard board, const bool black_turn, const SearchLimits limits) {
+    MoveList replies;
+    TableEntry entry{};
+    board.generate(black_turn, replies);
+    // the best reply of the last search is in the table, so it is ordered first.
+    this->table.probe(board.hash(black_turn), entry);
+    this->ordering.local().order(replies, black_turn, 0, entry);
+
+    for (const Move& reply : replies) {
+        const BitBoard after = board.play(black_turn, reply);
+        // every search has its own control, a search may stop its control by itself once it is done.
+        SearchControl control(limits);
+        {
+            std::lock_guard<std::mutex> guard(this->ponder_lock);
+            if (this->ponder_stopped)
+                return;
+            this->ponder_control = &control;
         }
+
+        const SearchResult result = this->best_line(after, !black_turn, limits, control);
+        {
+            std::lock_guard<std::mutex> guard(this->ponder_lock);
+            this->ponder_control = nullptr;
+            // a search cut short has no result.
+            if (this->ponder_stopped)
+                return;
+        }
+        this->pondered[Position(after, !black_turn)] = result;
     }
+}
 
-    return false;
+// the least a tablebase win can be worth at any level of the search.
+constexpr short TABLEBASE_WIN_LEAST = TABLEBASE_WIN - TABLEBASE_FAR_WIN - MAX_DEPTH;
+
+/**
+ * @brief a tablebase win counts the plies from the root of the search, in the transposition table it counts them from the position itself.
+ *
+ * @param eval
+ * @param level
+ * @return short
+ */
+short to_table(const short eval, const unsigned int level) {
+    if (eval >= TABLEBASE_WIN_LEAST && eval <= TABLEBASE_WIN)
+        return eval + level;
+    if (eval <= -TABLEBASE_WIN_LEAST && eval >= -TABLEBASE_WIN)
+        return eval - level;
+    return eval;
 }
 
 /**
- * @brief evaluate a TreeNode without looking at any depth of the position.
+ * @brief the inverse of to_table.
  *
+ * @param score
+ * @param level
  * @return short
  */
-short TreeNode::evaluate() {
-    this->eval = 2 * board.num_white() + board.num_white_kings() - 2 * board.num_black() - board.num_black_kings();
-    this->eval <<= 4;
+short from_table(const short score, const unsigned int level) {
+    if (score >= TABLEBASE_WIN_LEAST && score <= TABLEBASE_WIN)
+        return score - level;
+    if (score <= -TABLEBASE_WIN_LEAST && score >= -TABLEBASE_WIN)
+        return score + level;
+    return score;
+}
 
-    // center is worth more because it can impact more
-    for (unsigned int x = NUM_COLS / 4; x <= NUM_COLS - NUM_COLS / 4; x++) {
-        for (unsigned int y = (x & 1) + NUM_ROWS / 4 + 1; y < NUM_ROWS - NUM_ROWS / 4; y += 2) {
-            this->eval += (board.get(x, y) == Piece::WHITE) + (board.get(x, y) == Piece::WHITE_KING)
-                - (board.get(x, y) == Piece::BLACK) - (board.get(x, y) == Piece::BLACK_KING);
-        }
+/**
+ * @brief checks if entry, of a position at level, settles the position in the window alpha-beta. its score is converted to count from the root.
+ *
+ * @param entry
+ * @param level
+ * @param alpha
+ * @param beta
+ * @return true
+ * @return false
+ */
+bool settles(TableEntry& entry, const unsigned int level, const short alpha, const short beta) {
+    entry.score = from_table(entry.score, level);
+    return entry.bound == Bound::EXACT || (entry.bound == Bound::LOWER && entry.score >= beta) || (entry.bound == Bound::UPPER && entry.score <= alpha);
+}
+
+/**
+ * @brief looks board, at level of the search, up in the tablebase, returns true and sets eval if it is there.
+ * a win is worth less the more plies it takes from the root of the search.
+ *
+ * @param board
+ * @param black_turn
+ * @param level
+ * @param eval
+ * @return true
+ * @return false
+ */
+bool Engine::probe_tablebase(const BitBoard& board, const bool black_turn, const unsigned int level, short& eval) const {
+    if (this->tablebase == nullptr || !this->tablebase->probe(board, black_turn, eval))
+        return false;
+
+    eval = from_table(eval, level);
+    return true;
+}
+
+// history scores stay below the scores of killer moves.
+constexpr uint32_t HISTORY_LIMIT = (1U << 28) - 1;
+
+OrderingTables::OrderingTables() : killers{}, history{} {}
+
+/**
+ * @brief makes older searches count less than the coming one, killers are forgotten since plies no longer match.
+ *
+ */
+void OrderingTables::age() {
+    for (auto& ply_killers : this->killers)
+        ply_killers.fill(Move{});
+
+    for (auto& side : this->history)
+        for (auto& from : side)
+            for (auto& score : from)
+                score >>= 1;
+}
+
+/**
+ * @brief sorts moves so the most promising are searched first: the best move of an earlier search of the position (from entry),
+ * then captures of more pieces and promotions, then the killer moves of this ply, then by the history heuristic.
+ *
+ * @param moves
+ * @param black_turn
+ * @param level
+ * @param entry
+ */
+void OrderingTables::order(MoveList& moves, const bool black_turn, const unsigned int level, const TableEntry& entry) const {
+    std::array<uint32_t, MAX_MOVES> scores;
+    const auto& ply_killers = this->killers[level];
+
+    for (unsigned int i = 0; i < moves.size(); i++) {
+        const Move& move = moves[i];
+
+        if (entry.bound != Bound::NONE && entry.holds(move))
+            scores[i] = 1U << 31;
+        else if (move.captured != 0 || move.promotion)
+            scores[i] = (1U << 30) + (std::popcount(move.captured) << 1) + move.promotion;
+        else if (move == ply_killers[0])
+            scores[i] = 1U << 29;
+        else if (move == ply_killers[1])
+            scores[i] = (1U << 29) - 1;
+        else
+            scores[i] = this->history[black_turn][move.from][move.to];
     }
 
-    this->eval <<= 1;
+    // insertion sort, the lists are short and this keeps equal moves in generation order.
+    for (unsigned int i = 1; i < moves.size(); i++) {
+        const Move move = moves[i];
+        const uint32_t score = scores[i];
+        unsigned int j = i;
 
-    // Sides of the board are worth more because cannot be taken
-    for (unsigned int y = 1; y < NUM_ROWS; y += 2) {
-        this->eval += board.is_white(0, y) - board.is_black(0, y);
-        this->eval += board.is_white(NUM_COLS - 1, y - 1) - board.is_black(NUM_COLS - 1, y - 1);
+        for (; j > 0 && scores[j - 1] < score; j--) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[j] = move;
+        scores[j] = score;
+    }
+}
 
-        this->eval += board.is_white(y, 0) - board.is_black(y, 0);
-        this->eval += board.is_white(y - 1, NUM_ROWS - 1) - board.is_black(y - 1, NUM_ROWS - 1);
+/**
+ * @brief records that the non-capture move caused a cutoff at level with depth plies left to search.
+ *
+ * @param move
+ * @param black_turn
+ * @param level
+ * @param depth
+ */
+void OrderingTables::cutoff(const Move& move, const bool black_turn, const unsigned int level, const unsigned int depth) {
+    auto& ply_killers = this->killers[level];
+    if (ply_killers[0] != move) {
+        ply_killers[1] = ply_killers[0];
+        ply_killers[0] = move;
     }
 
-    return this->eval;
+    uint32_t& score = this->history[black_turn][move.from][move.to];
+    score = std::min(score + depth * depth, HISTORY_LIMIT);
 }
 
-std::ostream& operator<<(std::ostream& stream, std::vector<TreeNode>& nodes) {
-    auto it = nodes.begin();
+SearchControl::SearchControl(const SearchLimits& limits) :
+    limits(limits), start(std::chrono::steady_clock::now()), nodes(0), quiescence_nodes(0), stopped(false) {}
+
+/**
+ * @brief adds count visited nodes to the search, returns true if the search ran out of time or nodes and must stop.
+ *
+ * @param count
+ * @return true
+ * @return false
+ */
+bool SearchControl::add_nodes(const uint64_t count) {
+    const uint64_t total = this->nodes.fetch_add(count, std::memory_order_relaxed) + count;
+
+    if ((this->limits.nodes != 0 && total >= this->limits.nodes) || (this->limits.time > 0 && this->elapsed() >= this->limits.time))
+        this->stop();
 
-    stream << '[';
-    for (; it != nodes.end().operator--(); it++)
-        stream << it->eval << ", ";
-    stream << it->eval;
-    stream << ']';
+    return this->is_stopped();
+}
 
-    return stream;
+/**
+ * @brief adds count nodes visited past the depth of the search to resolve captures, they were already added with add_nodes.
+ *
+ * @param count
+ */
+void SearchControl::add_quiescence_nodes(const uint64_t count) {
+    this->quiescence_nodes.fetch_add(count, std::memory_order_relaxed);
 }
 
-std::ostream& operator<<(std::ostream& strm, TreeNode& root) {
-    strm << '[' << root.eval << ']' << std::endl;
-    std::vector<std::vector<TreeNode>*> edges = { &root.children };
-    while (edges.size() != 0) {
-        std::vector<std::vector<TreeNode>*> new_edges;
+bool SearchControl::is_stopped() const {
+    return this->stopped.load(std::memory_order_relaxed);
+}
 
-        for (auto& level : edges) {
-            strm << *level << " ";
+void SearchControl::stop() {
+    this->stopped.store(true, std::memory_order_relaxed);
+}
 
-            for (auto& node : *level) {
-                if (node.children.size() != 0)
-                    new_edges.push_back(&node.children);
-            }
-        }
-        strm << std::endl;
-        edges = std::move(new_edges);
+/**
+ * @brief seconds since the search started.
+ *
+ * @return double
+ */
+double SearchControl::elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - this->start).count();
+}
+
+uint64_t SearchControl::get_nodes() const {
+    return this->nodes.load(std::memory_order_relaxed);
+}
+
+uint64_t SearchControl::get_quiescence_nodes() const {
+    return this->quiescence_nodes.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief adds the statistics of a part of the search, its nodes are counted for the calling thread. no-op without SEARCH_STATS.
+ *
+ * @param part
+ */
+void SearchControl::add_stats(const SearchStats& part) {
+#ifdef SEARCH_STATS
+    uint64_t part_nodes = 0;
+    for (const uint64_t count : part.ply_nodes)
+        part_nodes += count;
+
+    const std::lock_guard<std::mutex> guard(this->stats_lock);
+    this->stats.add(part);
+    const auto thread = std::find(this->stats_threads.begin(), this->stats_threads.end(), std::this_thread::get_id());
+    if (thread == this->stats_threads.end()) {
+        this->stats_threads.push_back(std::this_thread::get_id());
+        this->stats.thread_nodes.push_back(part_nodes);
     }
+    else
+        this->stats.thread_nodes[thread - this->stats_threads.begin()] += part_nodes;
+#endif
+}
 
-    return strm;
+/**
+ * @brief records an iteration of the deepening that finished. no-op without SEARCH_STATS.
+ *
+ * @param iteration
+ */
+void SearchControl::add_iteration(const IterationStats& iteration) {
+#ifdef SEARCH_STATS
+    const std::lock_guard<std::mutex> guard(this->stats_lock);
+    this->stats.iterations.push_back(iteration);
+#endif
 }
 
-Engine::Engine() : position_history(std::unordered_map<const Position, unsigned int, hash_position>()), since_capture(0) {}
+/**
+ * @brief what the search did so far.
+ *
+ * @return SearchStats
+ */
+SearchStats SearchControl::get_stats() const {
+    SearchStats result;
+#ifdef SEARCH_STATS
+    {
+        const std::lock_guard<std::mutex> guard(this->stats_lock);
+        result = this->stats;
+    }
+#endif
+    result.nodes = this->get_nodes();
+    result.quiescence_nodes = this->get_quiescence_nodes();
+    return result;
+}
 
-unsigned int Engine::increment_position_history_counter(const Position& position) {
-    return ++this->position_history[position];
+/**
+ * @brief adds the counts of other to these, the threads of both are taken to be the same threads in the same order.
+ *
+ * @param other
+ */
+void SearchStats::add(const SearchStats& other) {
+    this->nodes += other.nodes;
+    this->quiescence_nodes += other.quiescence_nodes;
+    this->evaluations += other.evaluations;
+    this->table_probes += other.table_probes;
+    this->table_hits += other.table_hits;
+    for (unsigned int i = 0; i < CUTOFF_INDICES; i++)
+        this->cutoffs[i] += other.cutoffs[i];
+    for (unsigned int level = 0; level <= MAX_DEPTH; level++)
+        this->ply_nodes[level] += other.ply_nodes[level];
+    this->thread_nodes.resize(std::max(this->thread_nodes.size(), other.thread_nodes.size()));
+    for (unsigned int i = 0; i < other.thread_nodes.size(); i++)
+        this->thread_nodes[i] += other.thread_nodes[i];
+    this->iterations.insert(this->iterations.end(), other.iterations.begin(), other.iterations.end());
 }
 
-void Engine::increment_since_capture() {
-    this->since_capture++;
+/**
+ * @brief the average number of children searched of the nodes at level, 0 if none were visited.
+ *
+ * @param level
+ * @return double
+ */
+double SearchStats::branching_factor(const unsigned int level) const {
+    if (level >= MAX_DEPTH || this->ply_nodes[level] == 0)
+        return 0;
+    return (double)this->ply_nodes[level + 1] / this->ply_nodes[level];
 }
 
-void Engine::reset_since_capture() {
-    this->since_capture = 0;
+StatsScope::StatsScope(SearchControl* control) : stats(), control(control) {}
+
+StatsScope::~StatsScope() {
+    if (this->control != nullptr)
+        this->control->add_stats(this->stats);
 }
 
-unsigned int Engine::get_since_capture() {
-    return this->since_capture;
+SplitPoint::SplitPoint(const SplitPoint* parent, const uint64_t key, const unsigned int level, const short alpha, const short beta, const bool minimize) :
+    parent{ parent }, key{ key }, level{ level }, action{ false }, alpha{ alpha }, beta{ beta }, cut{ false }, eval{ (short)(minimize ? SHRT_MAX : SHRT_MIN) }, best{ 0 } {}
+
+/**
+ * @brief checks if the search of this split point or of one of the split points it is under was cut, then its result is not needed.
+ *
+ * @return true
+ * @return false
+ */
+bool SplitPoint::aborted() const {
+    for (const SplitPoint* split = this; split != nullptr; split = split->parent)
+        if (split->cut.load(std::memory_order_relaxed))
+            return true;
+
+    return false;
 }
 
 /**
- * @brief steps down in tree of alpha-beta pruning algorithm and updates all the necessary help data
+ * @brief checks if the position with key at level is the position of this split point or of one of the split points it is under.
  *
- * @param node
+ * @param key
+ * @param level
+ * @return true
+ * @return false
+ */
+bool SplitPoint::repeats(const uint64_t key, const unsigned int level) const {
+    // the same position with the same side to move can only be an even number of plies up the line.
+    for (const SplitPoint* split = this; split != nullptr; split = split->parent)
+        if ((level - split->level) % 2 == 0 && split->key == key)
+            return true;
+
+    return false;
+}
+
+/**
+ * @brief passes the evaluation of the move at index to the split point, cuts it if the window closed.
+ *
+ * @param index
+ * @param eval
  * @param minimize
- * @param appeared
- * @param indexes
- * @param level_ab
- * @param this_position
+ */
+void SplitPoint::update(const unsigned int index, const short eval, const bool minimize) {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    if (minimize ? eval < this->eval : eval > this->eval) {
+        this->eval = eval;
+        this->best = index;
+    }
+
+    if (minimize)
+        this->beta = std::min(this->beta.load(), eval);
+    else
+        this->alpha = std::max(this->alpha.load(), eval);
+
+    if (this->alpha >= this->beta)
+        this->cut = true;
+}
+
+/**
+ * @brief checks if the position with key at level already happened, at one of the split points above it or on the board during the game.
+ * if there is a good/bad move from it we would have found it in the "parent" copy, if the best move causes us to loop to it again => it's a draw.
+ *
+ * @param key
+ * @param board
+ * @param black_turn
  * @param level
+ * @param split the split point the position is under, may be nullptr.
+ * @return true
+ * @return false
  */
-void step_down(TreeNode*& node, bool& minimize, std::unordered_set<Position, hash_position>& appeared, std::vector<unsigned int>& indexes, std::vector<std::pair<short, short>>& level_ab, Position& this_position, unsigned int& level) {
-    // from this point on, this position has happened, will be removed by step_up later on.
-    appeared.insert(this_position);
-    // step down.
-    node = &node->children[indexes[level]];
-    // update this position and the minimize
-    minimize = !minimize;
-    this_position = Position(node->board, minimize);
-    // update the level in the tree
-    level++;
-    // when going down for the first time alpha-beta is simply the parent alpha-beta
-    level_ab[level] = level_ab[level - 1];
-    // this will ensure stepping down from this node works properly.
-    indexes[level] = 0;
+bool Engine::repeated(const uint64_t key, const BitBoard& board, const bool black_turn, const unsigned int level, const SplitPoint* split) const {
+    if (split != nullptr && split->repeats(key, level))
+        return true;
+
+    return level != 0 && this->position_history.size() != 0 && this->position_history.contains(Position(board, black_turn));
 }
 
 /**
- * @brief steps up in tree of alpha-beta pruning algorithm and updates all the necessary help data
+ * @brief steps down in the line of alpha-beta pruning algorithm to the move at the current ply's index, playing it on board, and updates all the necessary help data
  *
- * @param node
+ * @param line
+ * @param board
+ * @param level
  * @param minimize
- * @param appeared
- * @param history
- * @param indexes
- * @param level_ab
+ */
+void step_down(std::array<Ply, MAX_DEPTH + 1>& line, BitBoard& board, unsigned int& level, bool& minimize) {
+    const Ply& ply = line[level];
+    Ply& child = line[level + 1];
+
+    board.make(minimize, ply.moves[ply.index]);
+    child.key = board.hash(!minimize);
+    // when going down for the first time alpha-beta is simply the parent alpha-beta
+    child.alpha = ply.alpha;
+    child.beta = ply.beta;
+    child.original_alpha = ply.alpha;
+    child.original_beta = ply.beta;
+    child.action = ply.action || ply.captures;
+
+    level++;
+    minimize = !minimize;
+}
+
+/**
+ * @brief steps up in the line of alpha-beta pruning algorithm, taking back the move on board, passes the evaluation to the father and updates all the necessary help data
+ *
+ * @param line
+ * @param board
  * @param level
- * @param this_position
+ * @param minimize
  */
-void step_up(TreeNode*& node, bool& minimize, std::unordered_set<Position, hash_position>& appeared, const std::unordered_map<const Position, unsigned int, hash_position>& history, std::vector<unsigned int>& indexes, std::vector<std::pair<short, short>>& level_ab, unsigned int& level, Position& this_position, int& action_level) {
+void step_up(std::array<Ply, MAX_DEPTH + 1>& line, BitBoard& board, unsigned int& level, bool& minimize) {
+    const Ply& ply = line[level];
+    Ply& father = line[level - 1];
+
+    board.unmake(!minimize, father.moves[father.index]);
+
     // father is maximize
     if (minimize) {
-        node->father->eval = std::max(node->father->eval, node->eval);
+        if (ply.eval > father.eval) {
+            father.eval = ply.eval;
+            father.best = father.index;
+        }
         // if you do not understand this => look up alpha-beta pruning algorithm
-        short& alpha = std::get<0>(level_ab[level - 1]);
-        alpha = std::max(alpha, node->eval);
+        father.alpha = std::max(father.alpha, ply.eval);
     }
     // father is minimize
     else {
-        node->father->eval = std::min(node->father->eval, node->eval);
+        if (ply.eval < father.eval) {
+            father.eval = ply.eval;
+            father.best = father.index;
+        }
         // if you do not understand this => look up alpha-beta pruning algorithm
-        short& beta = std::get<1>(level_ab[level - 1]);
-        beta = std::min(beta, node->eval);
+        father.beta = std::min(father.beta, ply.eval);
     }
 
-    // step up
-    node = node->father;
-    if (action_level == (int)level)
-        action_level = -1;
     level--;
-    indexes[level]++;
+    father.index++;
     minimize = !minimize;
-    // update this position
-    this_position = Position(node->board, minimize);
-    // if this position was not in history i.e. a position that happened on the board, it is no longer in the set of positions that have accored in this line.
-    if (!history.contains(this_position))
-        appeared.erase(this_position);
 }
 
 /**
- * @brief implementation of alpha-beta pruning algorithm to find the best move given a depth.
+ * @brief implementation of alpha-beta pruning algorithm to find the evaluation of board given a depth.
+ * if control is given the visited nodes are reported to it, and once it is stopped the search returns at once with a meaningless result.
  *
  * @param root
  * @param black_turn
  * @param depth
+ * @param control
  * @return short
  */
-short Engine::alpha_beta_analysis(TreeNode* root, bool black_turn, const unsigned int depth) const {
-    std::vector<unsigned int> indexes(depth + 1, 0);
-    std::vector<std::pair<short, short>> level_ab(depth + 1, std::pair(SHRT_MIN, SHRT_MAX));
-    bool minimize = black_turn;
-    TreeNode* node = root;
-    unsigned int level = 0;
+short Engine::alpha_beta_analysis(const BitBoard& root, bool black_turn, const unsigned int depth, SearchControl* control) const {
+    return this->search(root, black_turn, depth, SHRT_MIN, SHRT_MAX, nullptr, control);
+}
 
+/**
+ * @brief searches root with one thread in the window alpha-beta.
+ * the search plays and takes back moves on a single copy of root, and only the line currently searched is kept, in a fixed array on the stack,
+ * so the search never touches the heap.
+ * positions at depth with a capture pending are not evaluated, the forced captures are searched beyond depth until the position is quiet.
+ * if root is a child of split, the search returns at once with a meaningless result once split is aborted, same as once control is stopped.
+ *
+ * @param root
+ * @param black_turn
+ * @param depth
+ * @param alpha
+ * @param beta
+ * @param split may be nullptr.
+ * @param control may be nullptr.
+ * @return short
+ */
+short Engine::search(const BitBoard& root, bool black_turn, const unsigned int depth, short alpha, short beta, const SplitPoint* split, SearchControl* control) const {
+    std::array<Ply, MAX_DEPTH + 1> line;
+    // the line is indexed by plies from the root of the whole search, the plies above root are split points.
+    const unsigned int first = split != nullptr ? split->level + 1 : 0;
+    const unsigned int max_level = std::min(first + depth, MAX_DEPTH);
     const unsigned int draw_no_action = NO_CAPTURE_DRAW - this->since_capture;
-    int action_level = -1;
-
-    std::unordered_set<Position, hash_position> appeared;
-    Position this_position(root->board, minimize);
-
-    do {
-        // if this node already appeared: if there is a good/bad move from it we would have found it in the "parent" copy, 
-        // if the best move causes is to loop to it again => it's a draw.
-        // so we can always evaluate it as a draw.
-        // another draw is by no action.
-        if (appeared.contains(this_position) || (level >= draw_no_action && action_level == -1)) {
-            node->eval = 0;
-
-            if (level == 0)
-                break;
-            step_up(node, minimize, appeared, this->position_history, indexes, level_ab, level, this_position, action_level);
-        }
-        // last nodes in tree needs to be evaluated
-        else if (level == depth) {
-            node->evaluate();
-            step_up(node, minimize, appeared, this->position_history, indexes, level_ab, level, this_position, action_level);
-        }
-        // if first time in this node:
-        else if (indexes[level] == 0) {
-            // default evaluation is worst, so we will change it from children for sure.
-            if (minimize)
-                node->eval = SHRT_MAX;
-            else
-                node->eval = SHRT_MIN;
-
-            if (node->expand(minimize) && action_level == -1)
-                action_level = level + 1;
-
-            // if this node is infact a loss:
-            if (node->children.size() == 0) {
-                // this means we lost the game
-                if (level == 0)
-                    break;
-                // move back up, father will be a winning move.
-                step_up(node, minimize, appeared, this->position_history, indexes, level_ab, level, this_position, action_level);
+    BitBoard board(root);
+    bool minimize = black_turn;
+    unsigned int level = first;
+    bool first_visit = true;
+    uint64_t nodes = 0;
+    // nodes past max_level, searched only to resolve pending captures.
+    uint64_t quiescence_nodes = 0;
+    OrderingTables& tables = this->ordering.local();
+    SEARCH_STAT(StatsScope scope(control));
+
+    line[first].key = board.hash(black_turn);
+    line[first].alpha = alpha;
+    line[first].beta = beta;
+    line[first].original_alpha = alpha;
+    line[first].original_beta = beta;
+    line[first].action = split != nullptr && split->action;
+
+    while (true) {
+        Ply& ply = line[level];
+
+        if (first_visit) {
+            first_visit = false;
+            TableEntry entry{};
+            short solved = 0;
+
+            if (++nodes % NODES_PER_CHECK == 0
+                && ((control != nullptr && control->add_nodes(NODES_PER_CHECK)) || (split != nullptr && split->aborted())))
+                return 0;
+            quiescence_nodes += level > max_level;
+            SEARCH_STAT(scope.stats.ply_nodes[level]++);
+
+            // repeated positions are a draw, another draw is by no action.
+            bool repeated = false;
+            for (unsigned int up = 2; up <= level - first && !repeated; up += 2)
+                repeated = line[level - up].key == ply.key;
+
+            if (repeated || this->repeated(ply.key, board, minimize, level, split) || (level >= draw_no_action && !ply.action))
+                ply.eval = 0;
+            // the endgame is solved, no need to search it.
+            else if (this->probe_tablebase(board, minimize, level, solved))
+                ply.eval = solved;
+            // last nodes in line needs to be evaluated, unless a capture is pending: then the captures are searched until the position is quiet.
+            else if (level >= max_level && (level == MAX_DEPTH || !board.jumpers(minimize))) {
+                ply.eval = evaluate(board);
+                SEARCH_STAT(scope.stats.evaluations++);
+            }
+            else {
+                // the position was already searched deep enough, and its score is usable in this window.
+                const bool found = level < max_level && this->table.probe(ply.key, entry);
+                SEARCH_STAT(scope.stats.table_probes += level < max_level; scope.stats.table_hits += found);
+                if (found && entry.depth >= max_level - level && settles(entry, level, ply.alpha, ply.beta))
+                    ply.eval = entry.score;
+                else {
+                    // default evaluation is worst, so we will change it from children for sure.
+                    ply.eval = minimize ? SHRT_MAX : SHRT_MIN;
+                    ply.captures = board.generate(minimize, ply.moves);
+                    ply.index = 0;
+                    ply.best = 0;
+
+                    // if there are no moves this is a loss and the worst evaluation stays, otherwise go down.
+                    if (!ply.moves.empty()) {
+                        tables.order(ply.moves, minimize, level, entry);
+                        step_down(line, board, level, minimize);
+                        first_visit = true;
+                        continue;
+                    }
+                }
             }
-            else
-                step_down(node, minimize, appeared, indexes, level_ab, this_position, level);
         }
-        // if we checked all this nodes children, or rendered then unimportant due to alpha-beta pruning
-        else if (indexes[level] >= node->children.size()) {
-            // unreachable??
-            if (level == 0)
-                break;
-            step_up(node, minimize, appeared, this->position_history, indexes, level_ab, level, this_position, action_level);
+        // go down unless we checked all this nodes children, or rendered then unimportant due to alpha-beta pruning
+        else if (ply.index < ply.moves.size() && !(minimize && ply.eval <= ply.alpha) && !(!minimize && ply.eval >= ply.beta)) {
+            step_down(line, board, level, minimize);
+            first_visit = true;
+            continue;
         }
-        // default option: we need to move down.
-        else {
-            // alpha-beta cutoff, alpha cutoff
-            if (minimize && node->eval <= level_ab[level].first) {
-                indexes[level] = node->children.size();
-                continue;
-            }
-            // alpha-beta cutoff, beta cutoff
-            if (!minimize && node->eval >= level_ab[level].second) {
-                indexes[level] = node->children.size();
-                continue;
-            }
-            step_down(node, minimize, appeared, indexes, level_ab, this_position, level);
+        // searched: remember the result and how it relates to the window it was searched with.
+        // captures past max_level are not remembered, they are searched again from every position that reaches them.
+        else if (level < max_level) {
+            Bound bound = Bound::EXACT;
+            if (ply.eval <= ply.original_alpha)
+                bound = Bound::UPPER;
+            else if (ply.eval >= ply.original_beta)
+                bound = Bound::LOWER;
+            this->table.store(ply.key, to_table(ply.eval, level), max_level - level, bound, &ply.moves[ply.best]);
+
+            // the side to move found a move too good for the other side to allow.
+            if (bound == (minimize ? Bound::UPPER : Bound::LOWER) && !ply.captures)
+                tables.cutoff(ply.moves[ply.best], minimize, level, max_level - level);
+            SEARCH_STAT(if (bound == (minimize ? Bound::UPPER : Bound::LOWER)) scope.stats.cutoffs[std::min(ply.best, CUTOFF_INDICES - 1)]++);
         }
-    } while (indexes[0] < root->children.size());
-    // while root was not fully evaluated.
 
-    return root->eval;
+        // this ply is fully evaluated
+        if (level == first)
+            break;
+        step_up(line, board, level, minimize);
+    }
+
+    if (control != nullptr) {
+        control->add_nodes(nodes % NODES_PER_CHECK);
+        control->add_quiescence_nodes(quiescence_nodes);
+    }
+
+    return line[first].eval;
+}
+
+/**
+ * @brief young brothers wait search of board in the window alpha-beta.
+ * the first move is searched alone, its result narrows the window and then the rest of the moves are searched in parallel sharing the window,
+ * once one of them closes the window the others are aborted. positions too close to the end of the search are searched by one thread.
+ * the result is meaningless if parent is aborted or control is stopped.
+ *
+ * @param board
+ * @param black_turn
+ * @param depth
+ * @param alpha
+ * @param beta
+ * @param parent the split point board is a child of, nullptr for the root of the search.
+ * @param control may be nullptr.
+ * @param best if not nullptr, set to the best move.
+ * @return short
+ */
+short Engine::parallel_search(const BitBoard& board, bool black_turn, const unsigned int depth, short alpha, short beta, const SplitPoint* parent, SearchControl* control, Move* best) const {
+    const unsigned int level = parent != nullptr ? parent->level + 1 : 0;
+    const bool action = parent != nullptr && parent->action;
+
+    // the root is always split so its best move is known.
+    if (level != 0 && depth < MIN_SPLIT_DEPTH)
+        return this->search(board, black_turn, depth, alpha, beta, parent, control);
+
+    if (control != nullptr && control->is_stopped())
+        return 0;
+
+    SplitPoint split(parent, board.hash(black_turn), level, alpha, beta, black_turn);
+    TableEntry entry{};
+    MoveList moves;
+    SEARCH_STAT(StatsScope scope(control));
+    SEARCH_STAT(scope.stats.ply_nodes[level]++);
+
+    // repeated positions are a draw, another draw is by no action.
+    if (this->repeated(split.key, board, black_turn, level, parent) || (level >= NO_CAPTURE_DRAW - this->since_capture && !action))
+        return 0;
+    // the endgame is solved, the root still needs a best move.
+    short solved = 0;
+    if (level != 0 && this->probe_tablebase(board, black_turn, level, solved))
+        return solved;
+    // the position was already searched deep enough, and its score is usable in this window, the root still needs a best move.
+    const bool found = this->table.probe(split.key, entry);
+    SEARCH_STAT(scope.stats.table_probes++; scope.stats.table_hits += found);
+    if (found && level != 0 && entry.depth >= depth && settles(entry, level, alpha, beta))
+        return entry.score;
+
+    const bool captures = board.generate(black_turn, moves);
+    // no moves is a loss.
+    if (moves.empty())
+        return split.eval;
+
+    this->ordering.local().order(moves, black_turn, level, entry);
+    split.action = action || captures;
+
+    // the first move decides the window the others are searched with.
+    split.update(0, this->parallel_search(board.play(black_turn, moves[0]), !black_turn, depth - 1, alpha, beta, &split, control), black_turn);
+
+    if (!split.cut && !split.aborted()) {
+        std::for_each(std::execution::par, moves.begin() + 1, moves.end(), [this, &board, &moves, &split, black_turn, depth, control](const Move& move) {
+            if (split.aborted())
+                return;
+
+            const short eval = this->parallel_search(board.play(black_turn, move), !black_turn, depth - 1, split.alpha, split.beta, &split, control);
+            // the search was aborted, its result is meaningless.
+            if (split.aborted() || (control != nullptr && control->is_stopped()))
+                return;
+            split.update(&move - moves.begin(), eval, black_turn);
+        });
+    }
+
+    if ((parent != nullptr && parent->aborted()) || (control != nullptr && control->is_stopped()))
+        return 0;
+
+    Bound bound = Bound::EXACT;
+    if (split.eval <= alpha)
+        bound = Bound::UPPER;
+    else if (split.eval >= beta)
+        bound = Bound::LOWER;
+    this->table.store(split.key, to_table(split.eval, level), depth, bound, &moves[split.best]);
+
+    // the side to move found a move too good for the other side to allow.
+    if (bound == (black_turn ? Bound::UPPER : Bound::LOWER) && !captures)
+        this->ordering.local().cutoff(moves[split.best], black_turn, level, depth);
+    SEARCH_STAT(if (bound == (black_turn ? Bound::UPPER : Bound::LOWER)) scope.stats.cutoffs[std::min(split.best, CUTOFF_INDICES - 1)]++);
+
+    if (best != nullptr)
+        *best = moves[split.best];
+    return split.eval;
 }
 
 /**
@@ -351,31 +1077,202 @@ short Engine::alpha_beta_analysis(TreeNode* root, bool black_turn, const unsigne
  * @param depth
  * @return std::pair<BitBoard, short>
  */
-std::pair<BitBoard, short> Engine::best_move(BitBoard board, bool black_turn, const unsigned int depth) const {
-    TreeNode root(board);
-    root.expand(black_turn);
-    std::atomic<short> eval;
+std::pair<BitBoard, short> Engine::best_move(BitBoard board, bool black_turn, const unsigned int depth) {
+    return this->best_move(board, black_turn, SearchLimits{ depth, 0, 0 });
+}
 
-    if (black_turn)
-        eval = SHRT_MAX;
-    else
-        eval = SHRT_MIN;
+/**
+ * @brief get the best possible next position and its evaluation, searching one ply deeper at a time until limits are reached.
+ * the result of the deepest iteration that finished is returned, an iteration that was cut short is thrown away.
+ *
+ * @param board
+ * @param black_turn
+ * @param limits
+ * @return std::pair<BitBoard, short>
+ */
+std::pair<BitBoard, short> Engine::best_move(BitBoard board, bool black_turn, const SearchLimits& limits) {
+    SearchControl control(limits);
+    return this->best_move(board, black_turn, limits, control);
+}
 
-    // optimize the move-search with parallel processing
-    std::for_each(std::execution::par, root.children.begin(), root.children.end(), [this, &eval, black_turn, depth](TreeNode& root) {
-        short temp_eval = this->alpha_beta_analysis(&root, !black_turn, depth - 1);
-        if (black_turn)
-            eval = std::min(eval.load(), temp_eval);
-        else
-            eval = std::max(eval.load(), temp_eval);
-    });
+/**
+ * @brief best_move that accounts the search in control, so the caller can see the nodes it visited or stop it.
+ *
+ * @param board
+ * @param black_turn
+ * @param limits the limits control was made with.
+ * @param control
+ * @return std::pair<BitBoard, short>
+ */
+std::pair<BitBoard, short> Engine::best_move(BitBoard board, bool black_turn, const SearchLimits& limits, SearchControl& control) {
+    const SearchResult result = this->best_line(board, black_turn, limits, control);
+    return std::pair(result.best, result.eval);
+}
+
+/**
+ * @brief searches board the same as best_move, and returns the best move itself and the principal variation that follows it as well.
+ *
+ * @param board
+ * @param black_turn
+ * @param limits
+ * @return SearchResult
+ */
+SearchResult Engine::best_line(const BitBoard& board, bool black_turn, const SearchLimits& limits) {
+    SearchControl control(limits);
+    return this->best_line(board, black_turn, limits, control);
+}
 
-    for (auto& child : root.children) {
-        if (child.eval == eval)
-            return std::pair<BitBoard, short>(child.board, eval);
+/**
+ * @brief best_line that accounts the search in control, so the caller can see the nodes it visited or stop it.
+ *
+ * @param board
+ * @param black_turn
+ * @param limits the limits control was made with.
+ * @param control
+ * @return SearchResult
+ */
+SearchResult Engine::best_line(const BitBoard& board, bool black_turn, const SearchLimits& limits, SearchControl& control) {
+    MoveList moves;
+    board.generate(black_turn, moves);
+
+    // no moves, nothing to search.
+    if (moves.empty())
+        return SearchResult{ board, 0, 0 };
+
+    // the position was the last one searched: its result is reused if it is deep enough, otherwise the search continues from it.
+    SearchResult result{ board, 0, 0 };
+    if (this->last_result.depth != 0 && this->last_position == Position(board, black_turn))
+        result = this->last_result;
+    if (result.depth >= std::clamp(limits.depth, 1U, MAX_DEPTH))
+        return result;
+
+    // a position in the book is played from it without searching, a book move stands for a search of any depth.
+    Move move;
+    short score = 0;
+    if (this->book != nullptr && this->book->choose(board, black_turn, this->random(), move, score))
+        result = SearchResult{ board.play(black_turn, move), score, MAX_DEPTH, move, { move } };
+    else if (this->mode == ParallelMode::SPLIT || this->threads == 1) {
+        this->start_search();
+        result = this->arena.execute([&]() { return this->deepen(board, black_turn, moves, limits, control, 0, result); });
     }
+    else {
+        this->start_search();
+        // every thread runs a search of its own, only the result of the main one is used, the helpers are stopped when it is done.
+        std::vector<std::thread> helpers;
+        helpers.reserve(this->threads - 1);
+        for (unsigned int helper = 1; helper < this->threads; helper++) {
+            helpers.emplace_back([&, helper]() {
+                tbb::task_arena alone(1);
+                alone.execute([&]() { this->deepen(board, black_turn, moves, limits, control, helper, result); });
+            });
+        }
 
-    // unreachable
-    return std::pair(board, 0);
+        tbb::task_arena alone(1);
+        const SearchResult main = alone.execute([&]() { return this->deepen(board, black_turn, moves, limits, control, 0, result); });
+        control.stop();
+        for (auto& helper : helpers)
+            helper.join();
+        result = main;
+    }
+
+    if (result.line.empty() || result.line.front() != result.move)
+        result.line = this->principal_variation(board, black_turn, result.move, result.depth);
+    this->last_position = Position(board, black_turn);
+    this->last_result = result;
+    return result;
 }
 
+/**
+ * @brief the principal variation of a search of board to depth that found first, read back from the best moves kept in the table.
+ * the line ends early where the table no longer has the next position, or the line repeats a position.
+ *
+ * @param board
+ * @param black_turn
+ * @param first the best move of board.
+ * @param depth
+ * @return std::vector<Move>
+ */
+std::vector<Move> Engine::principal_variation(BitBoard board, bool black_turn, const Move& first, const unsigned int depth) const {
+    std::vector<Move> line = { first };
+    std::unordered_set<uint64_t> seen = { board.hash(black_turn) };
+    board.make(black_turn, first);
+    black_turn = !black_turn;
+
+    while (line.size() < depth) {
+        const uint64_t key = board.hash(black_turn);
+        TableEntry entry{};
+        if (!seen.insert(key).second || !this->table.probe(key, entry) || !entry.has_move)
+            break;
+
+        // the table keeps only the source and route of a move, the legal move with them is the one.
+        MoveList moves;
+        board.generate(black_turn, moves);
+        const Move* next = std::find_if(moves.begin(), moves.end(), [&entry](const Move& move) { return entry.holds(move); });
+        if (next == moves.end())
+            break;
+
+        line.push_back(*next);
+        board.make(black_turn, *next);
+        black_turn = !black_turn;
+    }
+
+    return line;
+}
+
+/**
+ * @brief starts a new search for best_move: older entries of the table and older move ordering memory count less.
+ */
+void Engine::start_search() {
+    this->table.new_search();
+    for (auto& tables : this->ordering)
+        tables.age();
+}
+
+/**
+ * @brief the iterative deepening of best_move, run by every thread in LAZY_SMP mode and only by the calling thread otherwise.
+ * the iterations continue from the depth start was searched to, and helpers with an odd number start one ply deeper,
+ * so the threads are spread over two depths and fill the table for each other.
+ *
+ * @param board
+ * @param black_turn
+ * @param moves the moves from board, not empty.
+ * @param limits
+ * @param control
+ * @param helper 0 for the main search.
+ * @param start what was already searched of board, depth 0 if nothing was.
+ * @return SearchResult
+ */
+SearchResult Engine::deepen(const BitBoard& board, bool black_turn, const MoveList& moves, const SearchLimits& limits, SearchControl& control, const unsigned int helper, const SearchResult& start) const {
+    SearchResult result = start;
+    if (result.depth == 0) {
+        result.best = board.play(black_turn, moves[0]);
+        result.move = moves[0];
+    }
+    const unsigned int max_depth = std::clamp(limits.depth, 1U, MAX_DEPTH);
+
+    for (unsigned int depth = start.depth + 1 + (helper & 1); depth <= max_depth; depth++) {
+        Move best = moves[0];
+        // the best move of an iteration is kept in the table, so the next one searches it first.
+        const short eval = this->parallel_search(board, black_turn, depth, SHRT_MIN, SHRT_MAX, nullptr, &control, &best);
+        if (control.is_stopped())
+            break;
+        result = SearchResult{ board.play(black_turn, best), eval, depth, best };
+        SEARCH_STAT(if (helper == 0) control.add_iteration(IterationStats{ depth, eval, control.get_nodes(), control.elapsed() }));
+
+        // a forced move needs no more time, and an iteration that is not expected to finish in time is not started.
+        if (limits.time > 0 && (moves.size() == 1 || 2 * control.elapsed() >= limits.time))
+            break;
+    }
+
+    // stopped before any iteration finished: the move the table keeps for the position, from an earlier search or another thread, beats the first one.
+    TableEntry entry{};
+    if (result.depth == 0 && this->table.probe(board.hash(black_turn), entry)) {
+        const Move* known = std::find_if(moves.begin(), moves.end(), [&entry](const Move& move) { return entry.holds(move); });
+        if (known != moves.end()) {
+            result.best = board.play(black_turn, *known);
+            result.move = *known;
+        }
+    }
+
+    return result;
+}
@@ -4,52 +4,283 @@
 #include "bitboard.hpp"
 #include "helpFuncs.hpp"
 #include "consts.hpp"
+#include "move.hpp"
+#include "transposition.hpp"
+#include "tablebase.hpp"
+#include "book.hpp"
 #include <tuple>
+#include <array>
 #include <list>
 #include <climits>
-#include <boost/range/combine.hpp>
 #include <sstream>
 #include <atomic>
+#include <mutex>
+#include <chrono>
 #include <algorithm>
+#include <memory>
+#include <random>
 #include <unordered_map>
 #include <unordered_set>
-#include <boost/functional/hash.hpp>
+#include <thread>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/task_arena.h>
 
-struct TreeNode {
-    BitBoard board;
-    TreeNode* father;
+/**
+ * @brief one level of the line currently searched by alpha_beta_analysis, the whole line lives in a fixed array of these.
+ */
+struct Ply {
+    // zobrist key of the position at this ply with the side to move, the position itself is only on the board being searched.
+    uint64_t key;
+    MoveList moves;
+    // index of the move in moves that is searched next.
+    unsigned int index;
+    // index of the move in moves that reached eval.
+    unsigned int best;
+    short alpha;
+    short beta;
+    // the alpha-beta window the ply was entered with.
+    short original_alpha;
+    short original_beta;
     short eval;
-    std::vector<TreeNode> children;
-    TreeNode(const BitBoard state, TreeNode* father = nullptr, short eval = 0);
-    TreeNode(const TreeNode& other);
-    bool expand(bool black_turn);
-    short evaluate();
-    bool operator<(const TreeNode& other) const;
-    TreeNode& operator=(TreeNode&& other);
-    TreeNode& operator=(const TreeNode& other);
+    // the moves from this ply are captures.
+    bool captures;
+    // a capture was played somewhere on the line leading to this ply.
+    bool action;
 };
 
+/**
+ * @brief move ordering memory of one search thread, killer moves per ply and the history heuristic.
+ */
+struct OrderingTables {
+    // the last two non-capture moves that caused a cutoff at each ply.
+    std::array<std::array<Move, 2>, MAX_DEPTH + 1> killers;
+    // history[black_turn][from][to] => how much the non-capture move caused cutoffs, weighted by the depth left.
+    std::array<std::array<std::array<uint32_t, NUMBER_OF_REACHABLE_SQUARES>, NUMBER_OF_REACHABLE_SQUARES>, 2> history;
+
+    OrderingTables();
+    void age();
+    void order(MoveList& moves, const bool black_turn, const unsigned int level, const TableEntry& entry) const;
+    void cutoff(const Move& move, const bool black_turn, const unsigned int level, const unsigned int depth);
+};
+
+short evaluate(const BitBoard& board);
+void evaluate(const BitBoard* boards, const std::size_t count, short* evals);
+
 typedef std::pair<BitBoard, bool> Position;
 
 struct hash_position {
     std::size_t operator()(const Position& position) const;
 };
 
+/**
+ * @brief what a search is allowed to spend, it deepens one ply at a time until one of the limits is reached.
+ */
+struct SearchLimits {
+    // deepest iteration.
+    unsigned int depth = 6;
+    // seconds the search may take, 0 => no limit.
+    double time = 0;
+    // nodes the search may visit, 0 => no limit.
+    uint64_t nodes = 0;
+};
+
+// runs its statement only in builds with SEARCH_STATS defined (make STATS=1), otherwise the statistics of the search are compiled out.
+#ifdef SEARCH_STATS
+#define SEARCH_STAT(...) __VA_ARGS__
+#else
+#define SEARCH_STAT(...)
+#endif
+
+/**
+ * @brief an iteration of the deepening that finished: its depth, evaluation, and the nodes and seconds the search took up to its end.
+ */
+struct IterationStats {
+    unsigned int depth;
+    short eval;
+    uint64_t nodes;
+    double seconds;
+};
+
+/**
+ * @brief what a search did. nodes and quiescence_nodes are always counted, the rest only in builds with SEARCH_STATS.
+ */
+struct SearchStats {
+    uint64_t nodes = 0;
+    uint64_t quiescence_nodes = 0;
+    // positions evaluated at the end of a line.
+    uint64_t evaluations = 0;
+    uint64_t table_probes = 0;
+    // probes that found the position, whether or not its score could be used.
+    uint64_t table_hits = 0;
+    // cutoffs by the index in the move ordering of the move that caused them.
+    std::array<uint64_t, CUTOFF_INDICES> cutoffs{};
+    // nodes by plies from the root.
+    std::array<uint64_t, MAX_DEPTH + 1> ply_nodes{};
+    // nodes by the thread that visited them, in the order the threads joined the search.
+    std::vector<uint64_t> thread_nodes;
+    std::vector<IterationStats> iterations;
+
+    void add(const SearchStats& other);
+    double branching_factor(const unsigned int level) const;
+};
+
+/**
+ * @brief the state of one search shared by all the threads taking part in it: time and node accounting, and the stop flag.
+ */
+class SearchControl {
+private:
+    const SearchLimits limits;
+    const std::chrono::steady_clock::time_point start;
+    std::atomic<uint64_t> nodes;
+    // the part of nodes past the depth of the search, visited to resolve captures.
+    std::atomic<uint64_t> quiescence_nodes;
+    std::atomic<bool> stopped;
+#ifdef SEARCH_STATS
+    // guards stats and stats_threads.
+    mutable std::mutex stats_lock;
+    SearchStats stats;
+    // the thread of every entry of stats.thread_nodes.
+    std::vector<std::thread::id> stats_threads;
+#endif
+public:
+    SearchControl(const SearchLimits& limits);
+    bool add_nodes(const uint64_t count);
+    void add_quiescence_nodes(const uint64_t count);
+    bool is_stopped() const;
+    void stop();
+    double elapsed() const;
+    uint64_t get_nodes() const;
+    uint64_t get_quiescence_nodes() const;
+    void add_stats(const SearchStats& part);
+    void add_iteration(const IterationStats& iteration);
+    SearchStats get_stats() const;
+};
+
+/**
+ * @brief the statistics of the part of a search one call searches, added to the control of the search however the call returns.
+ */
+struct StatsScope {
+    SearchStats stats;
+    SearchControl* control;
+
+    StatsScope(SearchControl* control);
+    ~StatsScope();
+};
+
+/**
+ * @brief how the threads of an engine share the search of a move.
+ * SPLIT => the threads search different moves of the same positions (young brothers wait).
+ * LAZY_SMP => every thread searches the whole position on its own, they help each other only through the transposition table.
+ */
+enum class ParallelMode {
+    SPLIT,
+    LAZY_SMP
+};
+
+/**
+ * @brief a position whose moves are searched by several threads at once.
+ * the threads share its window through it, and learn through it when their work became irrelevant.
+ */
+struct SplitPoint {
+    const SplitPoint* parent;
+    uint64_t key;
+    // plies from the root of the search.
+    unsigned int level;
+    // a capture was played on the line leading to the children of this position.
+    bool action;
+    std::atomic<short> alpha;
+    std::atomic<short> beta;
+    // a move from this position is too good for the other side to allow, the moves still searched are irrelevant.
+    std::atomic<bool> cut;
+    // guards eval and best.
+    std::mutex lock;
+    short eval;
+    unsigned int best;
+
+    SplitPoint(const SplitPoint* parent, const uint64_t key, const unsigned int level, const short alpha, const short beta, const bool minimize);
+    bool aborted() const;
+    bool repeats(const uint64_t key, const unsigned int level) const;
+    void update(const unsigned int index, const short eval, const bool minimize);
+};
+
+/**
+ * @brief what a search of a position found: the position after the best move, its evaluation and the depth it was searched to,
+ * the best move itself and the line of best moves of both sides that follows it.
+ */
+struct SearchResult {
+    BitBoard best;
+    short eval;
+    // deepest iteration that finished, 0 => nothing was searched.
+    unsigned int depth;
+    // meaningless if the position has no moves.
+    Move move;
+    // the principal variation, starts with move.
+    std::vector<Move> line;
+};
+
 class Engine {
 public:
-    Engine();
-    short alpha_beta_analysis(TreeNode* root, bool black_turn, const unsigned int depth = 6) const;
-    std::pair<BitBoard, short> best_move(BitBoard board, bool black_turn, const unsigned int depth = 6) const;
+    Engine(const std::size_t table_megabytes = DEFAULT_TABLE_MEGABYTES, const unsigned int threads = 0, const ParallelMode mode = ParallelMode::SPLIT);
+    ~Engine();
+    short alpha_beta_analysis(const BitBoard& root, bool black_turn, const unsigned int depth = 6, SearchControl* control = nullptr) const;
+    std::pair<BitBoard, short> best_move(BitBoard board, bool black_turn, const unsigned int depth = 6);
+    std::pair<BitBoard, short> best_move(BitBoard board, bool black_turn, const SearchLimits& limits);
+    std::pair<BitBoard, short> best_move(BitBoard board, bool black_turn, const SearchLimits& limits, SearchControl& control);
+    SearchResult best_line(const BitBoard& board, bool black_turn, const SearchLimits& limits);
+    SearchResult best_line(const BitBoard& board, bool black_turn, const SearchLimits& limits, SearchControl& control);
     unsigned int increment_position_history_counter(const Position& position);
     void increment_since_capture();
     void reset_since_capture();
     unsigned int get_since_capture();
+    void set_table_size(const std::size_t megabytes);
+    void set_threads(const unsigned int threads);
+    unsigned int get_threads() const;
+    void set_parallel_mode(const ParallelMode mode);
+    unsigned int load_tablebase(const std::string& directory);
+    bool load_book(const std::string& path);
+    void ponder(const BitBoard& board, const bool black_turn, const SearchLimits& limits);
+    void stop_pondering();
+    bool pondered_move(const BitBoard& board, const bool black_turn, const SearchLimits& limits, SearchResult& result);
 private:
+    void ponder_replies(const BitBoard board, const bool black_turn, const SearchLimits limits);
+    SearchResult deepen(const BitBoard& board, bool black_turn, const MoveList& moves, const SearchLimits& limits, SearchControl& control, const unsigned int helper, const SearchResult& start) const;
+    void start_search();
+    std::vector<Move> principal_variation(BitBoard board, bool black_turn, const Move& first, const unsigned int depth) const;
+    void forget_last_search();
+    short search(const BitBoard& root, bool black_turn, const unsigned int depth, short alpha, short beta, const SplitPoint* split, SearchControl* control) const;
+    short parallel_search(const BitBoard& board, bool black_turn, const unsigned int depth, short alpha, short beta, const SplitPoint* parent, SearchControl* control, Move* best = nullptr) const;
+    bool probe_tablebase(const BitBoard& board, const bool black_turn, const unsigned int level, short& eval) const;
+    bool repeated(const uint64_t key, const BitBoard& board, const bool black_turn, const unsigned int level, const SplitPoint* split) const;
     std::unordered_map<const Position, unsigned int, hash_position> position_history;
     unsigned int since_capture;
+    // shared by every thread searching for this engine.
+    mutable TranspositionTable table;
+    // each thread searching for this engine orders its moves with its own tables.
+    mutable tbb::enumerable_thread_specific<OrderingTables> ordering;
+    unsigned int threads;
+    ParallelMode mode;
+    // the threads a split search runs on.
+    mutable tbb::task_arena arena;
+    // nullptr until a tablebase is loaded.
+    std::unique_ptr<Tablebase> tablebase;
+    // nullptr until an opening book is loaded.
+    std::unique_ptr<OpeningBook> book;
+    // picks among the moves of the book.
+    std::minstd_rand random;
+    // the position best_move searched last and what it found, reused or continued when it is asked about again, so an engine runs one search at a time.
+    Position last_position;
+    SearchResult last_result;
+    // searches the positions after the replies to the engine's move while the opponent thinks, see ponder.
+    std::thread ponderer;
+    // guards ponder_control and ponder_stopped.
+    std::mutex ponder_lock;
+    // the control of the search ponderer is running, nullptr between searches.
+    SearchControl* ponder_control;
+    bool ponder_stopped;
+    // the best moves of the positions pondered since the engine last started pondering, and the limits they were searched with.
+    std::unordered_map<const Position, SearchResult, hash_position> pondered;
+    SearchLimits ponder_limits;
 };
 
-std::ostream& operator<<(std::ostream& strm, TreeNode& root);
-
 
 #endif // ENGINE_HPP
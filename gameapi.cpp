@@ -1,7 +1,43 @@
 #include "gameapi.hpp"
 
 CheckersApi::CheckersApi(const unsigned int depth, BitBoard board, bool black_turn) :
-    depth(depth), board(board), black_turn(black_turn), draw(false), all_moves(this->board.moves(this->get_black_turn())), engine(Engine()) {
+    CheckersApi(SearchLimits{ depth, 0, 0 }, board, black_turn) {}
+
+CheckersApi::CheckersApi(const SearchLimits limits, BitBoard board, bool black_turn) :
+    limits(limits), board(board), black_turn(black_turn), draw(false), all_moves(this->board.moves(this->get_black_turn())), engine(Engine()) {
+}
+
+/**
+ * @brief cancels the searches still running in the background and waits for them, they report to the api.
+ *
+ */
+CheckersApi::~CheckersApi() {
+    py::gil_scoped_release release;
+    std::unique_lock<std::mutex> guard(this->searches_lock);
+    for (const auto& search : this->searches)
+        search->cancel();
+    this->searches_finished.wait(guard, [this]() { return this->searches.empty(); });
+}
+
+AsyncSearch::AsyncSearch(const SearchLimits& limits) : limits(limits), control(limits), cancelled(false) {}
+
+/**
+ * @brief the result is not wanted anymore, stops the search if it started and skips it otherwise.
+ *
+ */
+void AsyncSearch::cancel() {
+    this->cancelled = true;
+    this->control.stop();
+}
+
+/**
+ * @brief waits for the engine to be free and holds it, the gil is released while waiting so a search in the background can finish.
+ *
+ * @return std::unique_lock<std::mutex>
+ */
+std::unique_lock<std::mutex> CheckersApi::lock_engine() {
+    py::gil_scoped_release release;
+    return std::unique_lock<std::mutex>(this->engine_lock);
 }
 
 /**
@@ -58,17 +94,144 @@ bool CheckersApi::game_drawn() const {
     return this->draw;
 }
 
+/**
+ * @brief the current position in the standard checkers fen.
+ *
+ * @return std::string
+ */
+std::string CheckersApi::fen() const {
+    return to_fen(this->board, this->get_black_turn());
+}
+
+/**
+ * @brief the engine's search of board, answered from the pondering if it already searched it. the engine must be held.
+ *
+ * @param board
+ * @param black_turn
+ * @param limits
+ * @param control
+ * @return SearchResult
+ */
+SearchResult CheckersApi::search(const BitBoard& board, const bool black_turn, const SearchLimits& limits, SearchControl& control) {
+    SearchResult result;
+    if (!this->engine.pondered_move(board, black_turn, limits, result))
+        result = this->engine.best_line(board, black_turn, limits, control);
+    this->last_stats = control.get_stats();
+    return result;
+}
+
+/**
+ * @brief the engine's search of the current position, without the gil so other python threads run meanwhile. the engine must be held.
+ *
+ * @return SearchResult
+ */
+SearchResult CheckersApi::search() {
+    const SearchLimits limits = this->limits;
+    SearchControl control(limits);
+    py::gil_scoped_release release;
+    return this->search(this->board, this->get_black_turn(), limits, control);
+}
+
+/**
+ * @brief starts a search of the current position in the background, returns a concurrent.futures.Future of what report makes of its result.
+ * the position is the one of the call, the search waits for the engine to be free, and report is called with the engine and the gil held
+ * unless the future was cancelled. the future is cancelled if the game moved on before the search reports, so a search never plays a move for the other side.
+ * cancelling the future stops the search, the time limit counts from the call.
+ *
+ * @param report
+ * @return py::object
+ */
+py::object CheckersApi::search_async(std::function<py::object(CheckersApi&, const SearchResult&)> report) {
+    const std::shared_ptr<AsyncSearch> search = std::make_shared<AsyncSearch>(this->limits);
+    // read with the gil held, the game may move on before the search gets the engine.
+    const Position position(this->board, this->get_black_turn());
+    py::object future = py::module_::import("concurrent.futures").attr("Future")();
+    future.attr("add_done_callback")(py::cpp_function([search](py::object done) {
+        if (done.attr("cancelled")().cast<bool>())
+            search->cancel();
+    }));
+
+    {
+        const std::lock_guard<std::mutex> guard(this->searches_lock);
+        this->searches.push_back(search);
+    }
+
+    std::thread([this, search, future, report, position]() mutable {
+        {
+            const std::lock_guard<std::mutex> engine_guard(this->engine_lock);
+            SearchResult result{};
+            if (!search->cancelled)
+                result = this->search(position.first, position.second, search->limits, search->control);
+
+            py::gil_scoped_acquire acquire;
+            const bool moved_on = !(Position(this->board, this->get_black_turn()) == position);
+            if (search->cancelled || moved_on || future.attr("cancelled")().cast<bool>())
+                future.attr("cancel")();
+            else
+                future.attr("set_result")(report(*this, result));
+            // python objects are only let go of with the gil.
+            future = py::object();
+        }
+
+        const std::lock_guard<std::mutex> guard(this->searches_lock);
+        this->searches.erase(std::find(this->searches.begin(), this->searches.end(), search));
+        this->searches_finished.notify_all();
+    }).detach();
+
+    return future;
+}
+
+/**
+ * @brief the steps of move as pairs of coordinates, one step per jump of a series of captures.
+ *
+ * @param move
+ * @return std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>
+ */
+std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>> move_steps(const Move& move) {
+    const std::vector<unsigned int> squares = move_squares(move);
+    std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>> steps;
+    steps.reserve(squares.size() - 1);
+
+    for (unsigned int i = 0; i + 1 < squares.size(); i++)
+        steps.emplace_back(board_index_to_xy(squares[i]), board_index_to_xy(squares[i + 1]));
+    return steps;
+}
+
+/**
+ * @brief the steps of the best move found by a search and its evaluation, the game is over if it found no move.
+ *
+ * @param result
+ * @return std::pair<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>, short>
+ */
+std::pair<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>, short> best_move_steps(const SearchResult& result) {
+    // no moves, the game is over.
+    if (result.line.empty())
+        return std::pair{ std::vector{ std::pair{std::pair(0u, 0u), std::pair(0u, 0u)} }, 0 };
+
+    return std::pair(move_steps(result.move), result.eval);
+}
+
+/**
+ * @brief plays the move leading to after, as found by the engine. the engine must be held.
+ *
+ * @param after
+ */
+void CheckersApi::play_move(const BitBoard& after) {
+    this->set_board(after);
+    this->switch_turn();
+    this->all_moves = this->board.moves(this->get_black_turn());
+}
+
 /**
  * @brief plays the best move accoarsing to the engine.
  *
  * @return short
  */
 short CheckersApi::play() {
-    auto [best_position, eval] = engine.best_move(this->board, this->get_black_turn(), this->depth);
-    this->set_board(best_position);
-    this->switch_turn();
-    this->all_moves = this->board.moves(this->get_black_turn());
-    return eval;
+    const auto guard = this->lock_engine();
+    const SearchResult result = this->search();
+    this->play_move(result.best);
+    return result.eval;
 }
 
 /**
@@ -77,98 +240,237 @@ short CheckersApi::play() {
  * @return std::pair<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>, short>
  */
 std::pair<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>, short> CheckersApi::best_move() {
-    auto [next_best, eval] = engine.best_move(this->board, this->get_black_turn(), this->depth);
-    std::vector<std::pair<unsigned int, unsigned int>> path_to_end;
-
-    for (auto [x, y] : this->board) {
-        if (this->get_black_turn() && !this->board.is_black(x, y))
-            continue;
-        if (!this->get_black_turn() && !this->board.is_white(x, y))
-            continue;
-        // if we had a capture, or a series of captures, then we need to build the path.
-        //for (auto [x, y] : this->board) {
-            // locations that where reached.
-        std::vector<BitBoard> reached_jumps = { this->board };
-        // coordinates that where reached: jump_coords[i] will be the landing coordinate to get to reaches_jumps[i]
-        std::vector<std::pair<unsigned int, unsigned int>> jump_coords = { {x, y} };
-        // all of the current move paths.
-        std::vector<std::vector<std::pair<unsigned int, unsigned int>>> history = { jump_coords };
-
-        while (jump_coords.size() != 0) {
-            // the next iterations of the previos vectors.
-            std::vector<BitBoard> new_reached_jumps;
-            std::vector<std::pair<unsigned int, unsigned int>> new_coords_jumps;
-            std::vector<std::vector<std::pair<unsigned int, unsigned int>>> new_history;
-
-            for (unsigned i = 0; i < jump_coords.size(); i++) {
-                // for each position that was reached:
-                auto [source_x, source_y] = jump_coords[i];
-                auto current_position = reached_jumps[i];
-                auto& path = history[i];
-                // get all the candidates for the next capture:
-                auto candidates = get_candidate_locations(source_x, source_y);
-
-                // get all the next possible positions from this position:
-                bool captured = false;
-                for (auto [capture_x, capture_y] : candidates) {
-                    if (current_position.legal_capture(black_turn, source_x, source_y, capture_x, capture_y)) {
-                        new_reached_jumps.push_back(current_position.capture(source_x, source_y, capture_x, capture_y));
-                        new_coords_jumps.push_back(get_end_capture_pos(source_x, source_y, capture_x, capture_y));
-                        path.push_back(get_end_capture_pos(source_x, source_y, capture_x, capture_y));
-                        new_history.push_back(path);
-                        captured = true;
-                    }
-                }
-
-                // if we found the right one: we have the path
-                if (!captured && current_position == next_best) {
-                    // move the path to path_to_end and exit this lambda.
-                    path_to_end = std::move(path);
-                    goto BREAK_ALL_LOOPS;
-                }
-            }
+    const auto guard = this->lock_engine();
+    return best_move_steps(this->search());
+}
 
-            // update the relevent reached positions, last coords, and the paths.
-            reached_jumps = std::move(new_reached_jumps);
-            jump_coords = std::move(new_coords_jumps);
-            history = std::move(new_history);
-        }
-    }
+/**
+ * @brief the line the engine expects to be played from the current position, the best move first, every move as its steps.
+ *
+ * @return std::vector<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>>
+ */
+std::vector<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>> CheckersApi::principal_variation() {
+    const auto guard = this->lock_engine();
+    std::vector<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>> line;
+    for (const Move& move : this->search().line)
+        line.push_back(move_steps(move));
+    return line;
+}
 
-BREAK_ALL_LOOPS:
+/**
+ * @brief returns the coords for the first move in the best move
+ *
+ */
+std::pair<unsigned int, unsigned int> CheckersApi::hint() {
+    return this->best_move().first.front().first;
+}
 
-    // if the position was reaches
-    if (path_to_end.size() != 0) {
-        // convert it to the format that is needed for the return value.
-        std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>> result_path;
-        result_path.reserve(path_to_end.size() - 1);
-        for (unsigned i = 0; i < path_to_end.size() - 1; i++)
-            result_path.emplace_back(path_to_end[i], path_to_end[i + 1]);
+/**
+ * @brief play without waiting for the engine, returns a concurrent.futures.Future of the evaluation, the move is played once it is done.
+ * await it with asyncio.wrap_future, cancelling it stops the search and nothing is played.
+ *
+ * @return py::object
+ */
+py::object CheckersApi::play_async() {
+    return this->search_async([](CheckersApi& api, const SearchResult& result) {
+        api.play_move(result.best);
+        return py::cast(result.eval);
+    });
+}
 
-        // finally return it.
-        return std::pair(result_path, eval);
-    }
+/**
+ * @brief best_move without waiting for the engine, returns a concurrent.futures.Future of its result, cancelling it stops the search.
+ *
+ * @return py::object
+ */
+py::object CheckersApi::best_move_async() {
+    return this->search_async([](CheckersApi& api, const SearchResult& result) {
+        return py::cast(best_move_steps(result));
+    });
+}
 
-    // else it was not reached via captures, get all the possible next moves and the move serires to get to them: 
-    for (auto [x, y] : this->board) {
-        auto candidates = get_candidate_locations(x, y);
-        for (auto [dest_x, dest_y] : candidates) {
-            if (this->board.legal_move(this->get_black_turn(), x, y, dest_x, dest_y) && next_best == this->board.move(x, y, dest_x, dest_y))
-                return std::pair{ std::vector{ std::pair{std::pair(x, y), std::pair(dest_x, dest_y)} }, eval };
+/**
+ * @brief hint without waiting for the engine, returns a concurrent.futures.Future of its result, cancelling it stops the search.
+ *
+ * @return py::object
+ */
+py::object CheckersApi::hint_async() {
+    return this->search_async([](CheckersApi& api, const SearchResult& result) {
+        return py::cast(best_move_steps(result).first.front().first);
+    });
+}
 
-        }
+/**
+ * @brief what the last search of the engine did, as a dict. enabled is false unless the module was built with make STATS=1,
+ * without it only nodes and quiescence_nodes are counted.
+ *
+ * @return py::dict
+ */
+py::dict CheckersApi::search_stats() {
+    const auto guard = this->lock_engine();
+    const SearchStats& stats = this->last_stats;
+    py::dict result;
+#ifdef SEARCH_STATS
+    result["enabled"] = true;
+#else
+    result["enabled"] = false;
+#endif
+    result["nodes"] = stats.nodes;
+    result["quiescence_nodes"] = stats.quiescence_nodes;
+    result["evaluations"] = stats.evaluations;
+    result["table_probes"] = stats.table_probes;
+    result["table_hits"] = stats.table_hits;
+    result["cutoffs"] = std::vector<uint64_t>(stats.cutoffs.begin(), stats.cutoffs.end());
+
+    // plies past the deepest one visited are left out.
+    unsigned int plies = MAX_DEPTH + 1;
+    while (plies > 0 && stats.ply_nodes[plies - 1] == 0)
+        plies--;
+    std::vector<double> branching;
+    for (unsigned int level = 0; level + 1 < plies; level++)
+        branching.push_back(stats.branching_factor(level));
+    result["ply_nodes"] = std::vector<uint64_t>(stats.ply_nodes.begin(), stats.ply_nodes.begin() + plies);
+    result["branching"] = branching;
+    result["thread_nodes"] = stats.thread_nodes;
+
+    py::list iterations;
+    for (const IterationStats& iteration : stats.iterations) {
+        py::dict entry;
+        entry["depth"] = iteration.depth;
+        entry["eval"] = iteration.eval;
+        entry["nodes"] = iteration.nodes;
+        entry["seconds"] = iteration.seconds;
+        iterations.append(entry);
     }
+    result["iterations"] = iterations;
+    return result;
+}
 
-    // unreachable default return value
-    return std::pair{ std::vector{ std::pair{std::pair(0u, 0u), std::pair(0u, 0u)} }, 0 };
+/**
+ * @brief lets the engine search on the opponent's time: call once the engine moved, while the opponent thinks.
+ * the positions after the opponent's replies are searched in the background, the expected one first,
+ * so once the opponent moved play and best_move answer at once if its position was searched, and from a warm table otherwise.
+ *
+ */
+void CheckersApi::ponder() {
+    const auto guard = this->lock_engine();
+    if (!this->game_over())
+        this->engine.ponder(this->board, this->get_black_turn(), this->limits);
 }
 
 /**
- * @brief returns the coords for the first move in the best move
+ * @brief stops searching on the opponent's time, the engine stops by itself once the game changes.
  *
  */
-std::pair<unsigned int, unsigned int> CheckersApi::hint() {
-    return this->best_move().first.front().first;
+void CheckersApi::stop_pondering() {
+    const auto guard = this->lock_engine();
+    this->engine.stop_pondering();
+}
+
+/**
+ * @brief sets the size of the engine's transposition table in megabytes, what was searched so far is forgotten.
+ *
+ * @param megabytes
+ */
+void CheckersApi::set_table_size(const std::size_t megabytes) {
+    const auto guard = this->lock_engine();
+    this->engine.set_table_size(megabytes);
+}
+
+/**
+ * @brief limits every search to seconds, the engine plays the deepest move it finished by then. 0 => search to the full depth.
+ *
+ * @param seconds
+ */
+void CheckersApi::set_time_limit(const double seconds) {
+    this->limits.time = seconds;
+}
+
+/**
+ * @brief limits every search to visiting nodes positions. 0 => no limit.
+ *
+ * @param nodes
+ */
+void CheckersApi::set_node_limit(const uint64_t nodes) {
+    this->limits.nodes = nodes;
+}
+
+/**
+ * @brief sets the number of threads the engine searches with, 0 => one per hardware thread.
+ *
+ * @param threads
+ */
+void CheckersApi::set_threads(const unsigned int threads) {
+    const auto guard = this->lock_engine();
+    this->engine.set_threads(threads);
+}
+
+/**
+ * @brief sets how the engine's threads share a search.
+ *
+ * @param mode
+ */
+void CheckersApi::set_parallel_mode(const ParallelMode mode) {
+    const auto guard = this->lock_engine();
+    this->engine.set_parallel_mode(mode);
+}
+
+/**
+ * @brief lets the engine look endgames up in the tablebase files in directory, returns the number of files found.
+ *
+ * @param directory
+ * @return unsigned int
+ */
+unsigned int CheckersApi::load_tablebase(const std::string& directory) {
+    const auto guard = this->lock_engine();
+    return this->engine.load_tablebase(directory);
+}
+
+/**
+ * @brief lets the engine play the positions in the opening book file at path without searching, returns false if there is no book at path.
+ *
+ * @param path
+ * @return true
+ * @return false
+ */
+bool CheckersApi::load_book(const std::string& path) {
+    const auto guard = this->lock_engine();
+    return this->engine.load_book(path);
+}
+
+/**
+ * @brief counts the positions reached after depth moves from the current position, a series of captures is one move.
+ *
+ * @param depth
+ * @return uint64_t
+ */
+uint64_t CheckersApi::perft(const unsigned int depth) const {
+    const BitBoard board = this->board;
+    const bool black_turn = this->get_black_turn();
+    py::gil_scoped_release release;
+    return parallel_perft(board, black_turn, depth);
+}
+
+/**
+ * @brief perft of every move from the current position.
+ *
+ * @param depth at least 1.
+ * @return std::vector<std::pair<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>, uint64_t>> ((source, destination), count) of every move.
+ */
+std::vector<std::pair<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>, uint64_t>> CheckersApi::divide(const unsigned int depth) const {
+    std::vector<std::pair<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>, uint64_t>> result;
+    std::vector<std::pair<Move, uint64_t>> counts;
+    {
+        const BitBoard board = this->board;
+        const bool black_turn = this->get_black_turn();
+        py::gil_scoped_release release;
+        counts = ::divide(board, black_turn, std::max(depth, 1U));
+    }
+
+    for (const auto& [move, count] : counts)
+        result.emplace_back(std::pair(board_index_to_xy(move.from), board_index_to_xy(move.to)), count);
+
+    return result;
 }
 
 /**
@@ -202,6 +504,7 @@ bool CheckersApi::captures_available() const {
  * @return py::object
  */
 py::object CheckersApi::move(const unsigned int source_x, const unsigned int source_y, const unsigned int dest_x, const unsigned int dest_y) {
+    const auto guard = this->lock_engine();
     // get the after position if this move was a regular move or a capture
     BitBoard after_move = this->board.move(source_x, source_y, dest_x, dest_y);
     BitBoard after_capture = this->board.capture(source_x, source_y, (dest_x + source_x) / 2, (dest_y + source_y) / 2);
@@ -291,10 +594,149 @@ std::stringstream& operator<<(std::stringstream& strm, CheckersApi& api) {
     return (strm << api.board);
 }
 
+/**
+ * @brief the positions of an (N, 3) array of black, white and kings bitboards, checks black_turn has a side to move for each of them.
+ *
+ * @param boards
+ * @param black_turn
+ * @return std::vector<BitBoard>
+ */
+std::vector<BitBoard> read_boards(const py::array_t<uint32_t, py::array::c_style | py::array::forcecast>& boards, const py::array_t<bool, py::array::c_style | py::array::forcecast>& black_turn) {
+    if (boards.ndim() != 2 || boards.shape(1) != 3)
+        throw py::value_error("boards must have the shape (N, 3)");
+    const std::size_t count = boards.shape(0);
+    if (black_turn.ndim() != 1 || (std::size_t)black_turn.shape(0) != count)
+        throw py::value_error("black_turn must have the shape (N)");
+
+    const uint32_t* packed = boards.data();
+    std::vector<BitBoard> positions;
+    positions.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        const uint32_t black = packed[3 * i], white = packed[3 * i + 1], kings = packed[3 * i + 2];
+        if (!BitBoard::valid(black, white, kings))
+            throw py::value_error("boards[" + std::to_string(i) + "] is not a position");
+        positions.emplace_back(black, white, kings);
+    }
+    return positions;
+}
+
+/**
+ * @brief up to count records of reader from record start, as the boards and black_turn arrays analyze takes.
+ *
+ * @param reader
+ * @param start
+ * @param count
+ * @return py::tuple (boards, black_turn), fewer than count if the file ends first.
+ */
+py::tuple read_positions(const PositionReader& reader, const std::size_t start, const std::size_t count) {
+    const std::size_t size = start < reader.size() ? std::min(count, reader.size() - start) : 0;
+    py::array_t<uint32_t> boards({ (py::ssize_t)size, (py::ssize_t)3 });
+    py::array_t<bool> black_turn((py::ssize_t)size);
+    uint32_t* words = boards.mutable_data();
+    bool* turns = black_turn.mutable_data();
+
+    {
+        py::gil_scoped_release release;
+        for (std::size_t i = 0; i < size; i++) {
+            const uint8_t* record = reader.record(start + i);
+            for (unsigned int word = 0; word < 3; word++)
+                words[3 * i + word] = record[4 * word] | record[4 * word + 1] << 8 | record[4 * word + 2] << 16 | (uint32_t)record[4 * word + 3] << 24;
+            turns[i] = record[12] != 0;
+        }
+    }
+
+    return py::make_tuple(boards, black_turn);
+}
+
+/**
+ * @brief writes the positions of boards, with the sides to move of black_turn, to writer.
+ *
+ * @param writer
+ * @param boards
+ * @param black_turn
+ */
+void write_positions(PositionWriter& writer, const py::array_t<uint32_t, py::array::c_style | py::array::forcecast>& boards, const py::array_t<bool, py::array::c_style | py::array::forcecast>& black_turn) {
+    const std::vector<BitBoard> positions = read_boards(boards, black_turn);
+    const bool* turns = black_turn.data();
+    py::gil_scoped_release release;
+    for (std::size_t i = 0; i < positions.size(); i++)
+        writer.write(positions[i], turns[i]);
+}
+
+/**
+ * @brief searches every position of boards and writes its evaluation to scores and its best move to moves, without a python object per position.
+ * the positions are shared by threads threads (0 => one per hardware thread), every one with an engine of its own with a table of table_megabytes.
+ * depth 0 only evaluates the positions, all at once. a position without moves gets the score 0 and the move of zeros.
+ *
+ * @param boards (N, 3) the black, white and kings bitboards of every position.
+ * @param black_turn (N) the side to move of every position.
+ * @param scores (N) int16 output, positive is good for white.
+ * @param moves (N, 4) uint8 output, source x, source y, destination x and destination y of every best move.
+ * @param depth
+ * @param time_limit seconds every position may take, 0 => no limit.
+ * @param node_limit nodes every position may visit, 0 => no limit.
+ * @param threads
+ * @param table_megabytes
+ */
+void analyze(const py::array_t<uint32_t, py::array::c_style | py::array::forcecast>& boards, const py::array_t<bool, py::array::c_style | py::array::forcecast>& black_turn,
+    py::array_t<int16_t, py::array::c_style> scores, py::array_t<uint8_t, py::array::c_style> moves,
+    const unsigned int depth, const double time_limit, const uint64_t node_limit, const unsigned int threads, const std::size_t table_megabytes) {
+    const std::vector<BitBoard> positions = read_boards(boards, black_turn);
+    const std::size_t count = positions.size();
+    if (scores.ndim() != 1 || (std::size_t)scores.shape(0) != count)
+        throw py::value_error("scores must have the shape (N)");
+    if (moves.ndim() != 2 || (std::size_t)moves.shape(0) != count || moves.shape(1) != 4)
+        throw py::value_error("moves must have the shape (N, 4)");
+
+    const bool* turns = black_turn.data();
+    short* evals = scores.mutable_data();
+    uint8_t* steps = moves.mutable_data();
+
+    py::gil_scoped_release release;
+    std::fill(steps, steps + 4 * count, 0);
+
+    if (depth == 0) {
+        evaluate(positions.data(), count, evals);
+        return;
+    }
+
+    const SearchLimits limits{ std::min(depth, MAX_DEPTH), time_limit, node_limit };
+    std::atomic<std::size_t> next = 0;
+    const auto work = [&]() {
+        Engine engine(table_megabytes, 1);
+        for (std::size_t i = next++; i < count; i = next++) {
+            SearchControl control(limits);
+            const SearchResult result = engine.best_line(positions[i], turns[i], limits, control);
+            evals[i] = result.line.empty() ? 0 : result.eval;
+            if (result.line.empty())
+                continue;
+
+            const auto [from_x, from_y] = board_index_to_xy(result.move.from);
+            const auto [to_x, to_y] = board_index_to_xy(result.move.to);
+            steps[4 * i] = from_x;
+            steps[4 * i + 1] = from_y;
+            steps[4 * i + 2] = to_x;
+            steps[4 * i + 3] = to_y;
+        }
+    };
+
+    const std::size_t workers = std::min<std::size_t>(threads != 0 ? threads : std::max(std::thread::hardware_concurrency(), 1U), std::max<std::size_t>(count, 1));
+    std::vector<std::thread> helpers;
+    helpers.reserve(workers - 1);
+    for (std::size_t helper = 1; helper < workers; helper++)
+        helpers.emplace_back(work);
+    work();
+    for (auto& helper : helpers)
+        helper.join();
+}
+
 PYBIND11_MODULE(checkers, handle) {
     handle.doc() =
         "Basic checkers api to handle the checkers game\n"
-        "Api.Api => constructor for the api.\n"
+        "Api.Api(depth: int = 6, time_limit: float = 0, node_limit: int = 0, threads: int = 0, parallel_mode: ParallelMode = ParallelMode.SPLIT, fen: str = "") => constructor for the api,\n"
+        "    the engine deepens its search up to depth and stops early once it used time_limit seconds or visited node_limit positions (0 => no limit).\n"
+        "    it searches with threads threads (0 => one per hardware thread) shared according to parallel_mode.\n"
+        "    the game starts from the position in fen, the standard checkers fen, or from the starting position without it.\n"
         "Api.is_white(x: int, y: int) -> bool, checks if the piece at (x, y) coordinates is white\n"
         "Api.is_black(x: int, y: int) -> bool, checks if the piece at (x, y) coordinates is black\n"
         "Api.is_king(x: int, y: int) -> bool, checks if the piece at (x, y) coordinates is a king\n"
@@ -302,9 +744,42 @@ PYBIND11_MODULE(checkers, handle) {
         "Api.move(source_x: int, source_y: int, dest_x: int, dest_: int) -> tuple, checks if a move is legal, if so plays it, returns None if move is not legall otherwise returns the end position\n"
         "Api.play() -> None, plays the best move according to the engine.\n"
         "Api.best_move() -> tuple[list[tuple[tuple[int, int], tuple[int, int]]], int], returns a list representing the best move, and the evaluation of the end position from that move\n"
+        "Api.principal_variation() -> list[list[tuple[tuple[int, int], tuple[int, int]]]], the line of moves the engine expects from the position, the best move first, every move in the format of best_move\n"
+        "Api.play_async() -> concurrent.futures.Future[int], play in the background, the move is played once the future is done, cancelling it stops the search, it is cancelled if the game moves on first\n"
+        "Api.best_move_async() -> concurrent.futures.Future, best_move in the background, cancelling it stops the search, await it with asyncio.wrap_future\n"
+        "Api.hint_async() -> concurrent.futures.Future, hint in the background, cancelling it stops the search\n"
+        "Api.search_stats() -> dict, what the last search did: nodes, quiescence_nodes, and with a module built with make STATS=1 (enabled) also evaluations,\n"
+        "    table_probes, table_hits, cutoffs by move index, ply_nodes and branching by ply, thread_nodes and iterations (depth, eval, nodes, seconds)\n"
+        "Api.ponder() -> None, searches the opponent's replies in the background until the opponent moves, call it once the engine moved\n"
+        "Api.stop_pondering() -> None, stops searching the opponent's replies\n"
+        "Api.set_table_size(megabytes: int) -> None, sets the size of the engine's transposition table, forgets what was searched so far\n"
+        "Api.set_time_limit(seconds: float) -> None, sets the time the engine may spend on a move, 0 => no limit\n"
+        "Api.set_node_limit(nodes: int) -> None, sets the number of positions the engine may visit per move, 0 => no limit\n"
+        "Api.set_threads(threads: int) -> None, sets the number of threads the engine searches with, 0 => one per hardware thread\n"
+        "Api.set_parallel_mode(mode: ParallelMode) -> None, sets how the engine's threads share a search\n"
+        "Api.load_tablebase(directory: str) -> int, lets the engine look endgames up in the tablebase files built by tbgen in directory, returns the number of files found\n"
+        "Api.perft(depth: int) -> int, counts the positions reached after depth moves from the current position, a series of captures is one move\n"
+        "Api.divide(depth: int) -> list[tuple[tuple[tuple[int, int], tuple[int, int]], int]], the perft count after every move from the current position with the move's source and destination\n"
+        "Api.load_book(path: str) -> bool, lets the engine play from the opening book file built by bookgen at path, returns False if there is no book there\n"
+        "analyze(boards: numpy.ndarray, black_turn: numpy.ndarray, scores: numpy.ndarray, moves: numpy.ndarray, depth: int = 6, time_limit: float = 0, node_limit: int = 0, threads: int = 0, table_size: int = 16) -> None,\n"
+        "    searches every position of the (N, 3) uint32 array boards (black, white and kings bitboards) with the side to move in black_turn,\n"
+        "    writes the evaluations to the (N) int16 array scores and the best moves to the (N, 4) uint8 array moves as source x, source y, destination x, destination y.\n"
+        "    the positions are spread over threads threads (0 => one per hardware thread) with an engine of table_size megabytes each, depth 0 only evaluates them\n"
+        "PositionReader(path: str) => the file of 13 byte position records at path, memory mapped: the black, white and kings bitboards as little endian uint32 and the side to move (1 => black)\n"
+        "PositionReader.__len__() -> int, the number of records\n"
+        "PositionReader.__getitem__(index: int) -> str, the position of record index in fen\n"
+        "PositionReader.read(start: int, count: int) -> tuple[numpy.ndarray, numpy.ndarray], up to count records from start as the boards and black_turn arrays of analyze\n"
+        "PositionWriter(path: str, append: bool = False) => writes records to the file at path, a context manager that closes the file\n"
+        "PositionWriter.write(fen: str) -> None, adds the position in fen\n"
+        "PositionWriter.write_many(boards: numpy.ndarray, black_turn: numpy.ndarray) -> None, adds the positions in the arrays of analyze\n"
+        "PositionWriter.close() -> bool, writes the records still buffered and closes the file, returns False if writing failed\n"
+        "ParallelMode.SPLIT => the threads search different moves of the same positions\n"
+        "ParallelMode.LAZY_SMP => every thread searches the whole position, sharing only the transposition table\n"
+        "MAX_DEPTH -> int, the deepest the engine can search\n"
         "Api.__len__() -> int, returns the length or width of the board (equal)\n"
         "Api.__str__() -> str, returns the board in a string format as well as who has the move on the top\n"
         "Api.black_move -> bool, is it's blacks turn\n"
+        "Api.fen -> str, the position in the standard checkers fen, e.g. B:W21,22,23,24,25,26,27,28,29,30,31,32:B1,2,3,4,5,6,7,8,9,10,11,12\n"
         "Api.white_move -> bool, is it's blacks turn\n"
         "Api.game_over -> bool, has the game ended\n"
         "Api.draw -> bool, has the game ended in a draw\n"
@@ -320,9 +795,76 @@ PYBIND11_MODULE(checkers, handle) {
         .def("__str__", [](Piece& self) { std::stringstream s; s << self; return s.str(); })
         ;
 
+    py::enum_<ParallelMode>(handle, "ParallelMode")
+        .value("SPLIT", ParallelMode::SPLIT)
+        .value("LAZY_SMP", ParallelMode::LAZY_SMP)
+        ;
+
+    handle.attr("MAX_DEPTH") = MAX_DEPTH;
+
+    py::class_<PositionReader>(handle, "PositionReader")
+        .def(py::init([](const std::string& path) {
+                auto reader = std::make_unique<PositionReader>();
+                if (!reader->load(path))
+                    throw py::value_error(path + " is not a file of position records");
+                return reader;
+            }),
+            py::arg("path"))
+        .def("__len__", &PositionReader::size)
+        .def("__getitem__",
+            [](const PositionReader& self, const std::size_t index) {
+                BitBoard board;
+                bool black_turn;
+                if (index >= self.size())
+                    throw py::index_error("record out of range");
+                if (!self.get(index, board, black_turn))
+                    throw py::value_error("record " + std::to_string(index) + " is not a position");
+                return to_fen(board, black_turn);
+            },
+            py::arg("index"))
+        .def("read", &read_positions, py::arg("start"), py::arg("count"))
+        ;
+
+    py::class_<PositionWriter>(handle, "PositionWriter")
+        .def(py::init([](const std::string& path, const bool append) {
+                auto writer = std::make_unique<PositionWriter>();
+                if (!writer->open(path, append))
+                    throw py::value_error("cannot write to " + path);
+                return writer;
+            }),
+            py::arg("path"), py::arg("append") = false)
+        .def("write",
+            [](PositionWriter& self, const std::string& fen) {
+                BitBoard board;
+                bool black_turn;
+                if (!from_fen(fen, board, black_turn))
+                    throw py::value_error("not a position: " + fen);
+                self.write(board, black_turn);
+            },
+            py::arg("fen"))
+        .def("write_many", &write_positions, py::arg("boards"), py::arg("black_turn"))
+        .def("close", &PositionWriter::close)
+        .def("__len__", &PositionWriter::size)
+        .def("__enter__", [](PositionWriter& self) -> PositionWriter& { return self; }, py::return_value_policy::reference)
+        .def("__exit__", [](PositionWriter& self, py::args) { self.close(); })
+        ;
+
+    handle.def("analyze", &analyze, py::arg("boards"), py::arg("black_turn"), py::arg("scores").noconvert(), py::arg("moves").noconvert(),
+        py::arg("depth") = 6, py::arg("time_limit") = 0.0, py::arg("node_limit") = 0, py::arg("threads") = 0, py::arg("table_size") = 16);
+
     py::class_<CheckersApi>(handle, "Api")
-        .def(py::init<unsigned int>())
-        .def(py::init<>())
+        .def(py::init([](unsigned int depth, double time_limit, uint64_t node_limit, unsigned int threads, ParallelMode parallel_mode, const std::string& fen) {
+                BitBoard board;
+                bool black_turn = true;
+                if (!fen.empty() && !from_fen(fen, board, black_turn))
+                    throw py::value_error("not a position: " + fen);
+                // the engine owns its pondering thread, so the api is made in place rather than moved.
+                auto api = std::make_unique<CheckersApi>(SearchLimits{ depth, time_limit, node_limit }, board, black_turn);
+                api->set_threads(threads);
+                api->set_parallel_mode(parallel_mode);
+                return api;
+            }),
+            py::arg("depth") = 6, py::arg("time_limit") = 0.0, py::arg("node_limit") = 0, py::arg("threads") = 0, py::arg("parallel_mode") = ParallelMode::SPLIT, py::arg("fen") = "")
         .def("is_white", &CheckersApi::is_white, py::arg("x"), py::arg("y"))
         .def("is_black", &CheckersApi::is_black, py::arg("x"), py::arg("y"))
         .def("is_king", &CheckersApi::is_king, py::arg("x"), py::arg("y"))
@@ -331,6 +873,22 @@ PYBIND11_MODULE(checkers, handle) {
         .def("play", &CheckersApi::play)
         .def("hint", &CheckersApi::hint)
         .def("best_move", &CheckersApi::best_move)
+        .def("principal_variation", &CheckersApi::principal_variation)
+        .def("play_async", &CheckersApi::play_async)
+        .def("best_move_async", &CheckersApi::best_move_async)
+        .def("hint_async", &CheckersApi::hint_async)
+        .def("search_stats", &CheckersApi::search_stats)
+        .def("ponder", &CheckersApi::ponder)
+        .def("stop_pondering", &CheckersApi::stop_pondering)
+        .def("set_table_size", &CheckersApi::set_table_size, py::arg("megabytes"))
+        .def("set_time_limit", &CheckersApi::set_time_limit, py::arg("seconds"))
+        .def("set_node_limit", &CheckersApi::set_node_limit, py::arg("nodes"))
+        .def("set_threads", &CheckersApi::set_threads, py::arg("threads"))
+        .def("set_parallel_mode", &CheckersApi::set_parallel_mode, py::arg("mode"))
+        .def("load_tablebase", &CheckersApi::load_tablebase, py::arg("directory"))
+        .def("load_book", &CheckersApi::load_book, py::arg("path"))
+        .def("perft", &CheckersApi::perft, py::arg("depth"))
+        .def("divide", &CheckersApi::divide, py::arg("depth"))
         .def("__len__", [](CheckersApi& self) { return NUM_ROWS; })
         .def("__str__",
             [](CheckersApi& self) {
@@ -342,6 +900,7 @@ PYBIND11_MODULE(checkers, handle) {
                 .def_property_readonly("white_move", [](CheckersApi& self) { return !self.get_black_turn(); })
                 .def_property_readonly("game_over", &CheckersApi::game_over)
                 .def_property_readonly("draw", &CheckersApi::game_drawn)
+                .def_property_readonly("fen", &CheckersApi::fen)
                 .def("__getitem__",
                     [](CheckersApi& self, py::tuple values) {
                         auto [x, y] = values.cast<std::tuple<int, int>>();
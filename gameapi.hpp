@@ -10,23 +10,59 @@
 #include <pybind11/stl.h>
 #include <sstream>
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include "helpFuncs.hpp"
 #include "engine.hpp"
+#include "perft.hpp"
+#include "notation.hpp"
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <condition_variable>
 
 namespace py = pybind11;
 
+/**
+ * @brief a search running in the background for one of the asynchronous calls of the api, shared with the future it reports to.
+ */
+struct AsyncSearch {
+    const SearchLimits limits;
+    SearchControl control;
+    // the future was cancelled or the api is going away, the search result is not wanted.
+    std::atomic<bool> cancelled;
+
+    AsyncSearch(const SearchLimits& limits);
+    void cancel();
+};
+
 class CheckersApi {
 private:
-    const unsigned int depth;
+    SearchLimits limits;
     BitBoard board;
     bool black_turn;
     bool draw;
     std::vector<BitBoard> all_moves;
     Engine engine;
+    // what the last search of the engine did.
+    SearchStats last_stats;
+    // held while the engine or the board is changed or the engine searches, only ever taken without the gil.
+    std::mutex engine_lock;
+    // guards searches.
+    std::mutex searches_lock;
+    std::condition_variable searches_finished;
+    std::vector<std::shared_ptr<AsyncSearch>> searches;
     void switch_turn();
+    std::unique_lock<std::mutex> lock_engine();
+    SearchResult search(const BitBoard& board, const bool black_turn, const SearchLimits& limits, SearchControl& control);
+    SearchResult search();
+    py::object search_async(std::function<py::object(CheckersApi&, const SearchResult&)> report);
     void set_board(BitBoard new_board);
+    void play_move(const BitBoard& after);
 public:
     CheckersApi(const unsigned int depth = 6, BitBoard board = BitBoard(), bool black_turn = true);
+    CheckersApi(const SearchLimits limits, BitBoard board = BitBoard(), bool black_turn = true);
+    ~CheckersApi();
     py::object move(const unsigned int source_x, const unsigned int source_y, const unsigned int dest_x, const unsigned int dest_y);
     Piece get(const unsigned int x, const unsigned int y) const;
     bool get_black_turn() const;
@@ -35,14 +71,38 @@ public:
     bool is_king(const unsigned int x, const unsigned int y) const;
     bool game_over() const;
     bool game_drawn() const;
+    std::string fen() const;
     bool captures_available() const;
     std::vector<std::pair<unsigned int, unsigned int>> possible_moves(const unsigned int x, const unsigned int y) const;
     short play();
     std::pair<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>, short> best_move();
+    std::vector<std::vector<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>>> principal_variation();
     std::pair<unsigned int, unsigned int> hint();
+    py::object play_async();
+    py::object best_move_async();
+    py::object hint_async();
+    py::dict search_stats();
+    void ponder();
+    void stop_pondering();
+    void set_table_size(const std::size_t megabytes);
+    void set_time_limit(const double seconds);
+    void set_node_limit(const uint64_t nodes);
+    void set_threads(const unsigned int threads);
+    void set_parallel_mode(const ParallelMode mode);
+    unsigned int load_tablebase(const std::string& directory);
+    bool load_book(const std::string& path);
+    uint64_t perft(const unsigned int depth) const;
+    std::vector<std::pair<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, unsigned int>>, uint64_t>> divide(const unsigned int depth) const;
     friend std::stringstream& operator<<(std::stringstream& strm, CheckersApi& api);
 };
 
 std::stringstream& operator<<(std::stringstream& strm, CheckersApi& api);
 
+std::vector<BitBoard> read_boards(const py::array_t<uint32_t, py::array::c_style | py::array::forcecast>& boards, const py::array_t<bool, py::array::c_style | py::array::forcecast>& black_turn);
+py::tuple read_positions(const PositionReader& reader, const std::size_t start, const std::size_t count);
+void write_positions(PositionWriter& writer, const py::array_t<uint32_t, py::array::c_style | py::array::forcecast>& boards, const py::array_t<bool, py::array::c_style | py::array::forcecast>& black_turn);
+void analyze(const py::array_t<uint32_t, py::array::c_style | py::array::forcecast>& boards, const py::array_t<bool, py::array::c_style | py::array::forcecast>& black_turn,
+    py::array_t<int16_t, py::array::c_style> scores, py::array_t<uint8_t, py::array::c_style> moves,
+    const unsigned int depth, const double time_limit, const uint64_t node_limit, const unsigned int threads, const std::size_t table_megabytes);
+
 #endif // GAMEAPI_HPP
@@ -9,7 +9,7 @@ from argparse import ArgumentParser
 
 import pygame
 
-from checkers import Api
+from checkers import Api, MAX_DEPTH, ParallelMode
 from consts import *
 
 FPS = 60
@@ -103,22 +103,34 @@ def draw(win, checkers_api: Api, selection: tuple[int]=None, hint: tuple[int]=No
         for x, y in checkers_api.legal_moves(*selection):
             circle_square(win, BLUE, (x, y), radius=SQUARE_SIZE // 4, rotation=rotation)
         
-def handle_game(depth: int=6, color: str="black", delay: float=0.5, flip: bool=False):
+def handle_game(depth: int=6, color: str="black", delay: float=0.5, flip: bool=False, time: float=0, threads: int=0, lazy_smp: bool=False, tablebase: str=None, book: str=None, ponder: bool=False):
     """handle the game between the user and the engine
 
     Args:
         depth (int, optional): The number depth of moves the engine will look into. Defaults to 6.
         color (str, optional): The color the user wants to play. Defaults to "black".
         rotate (bool, optional): Wether or not the user wants a rotated screen. Defaults to False.
+        time (float, optional): Seconds the engine may think on a move, 0 for no limit. Defaults to 0.
+        threads (int, optional): Threads the engine searches with, 0 for one per hardware thread. Defaults to 0.
+        lazy_smp (bool, optional): Wether the engine's threads search independently sharing only the transposition table. Defaults to False.
+        tablebase (str, optional): Directory of endgame tablebase files for the engine. Defaults to None.
+        book (str, optional): Opening book file for the engine. Defaults to None.
+        ponder (bool, optional): Wether the engine searches the user's replies while the user thinks. Defaults to False.
     """    
     win = pygame.display.set_mode((WIDTH, HEIGHT))  
     pygame.display.set_caption("Checkers")
     # the usual rotation of the board is color == "white", if user asked to rotate != rotate rotates it again.
     rotation = (color == "white") != flip
     clock = pygame.time.Clock()
-    game_api = Api(depth)
+    game_api = Api(depth, time, threads=threads, parallel_mode=ParallelMode.LAZY_SMP if lazy_smp else ParallelMode.SPLIT)
+    if tablebase:
+        game_api.load_tablebase(tablebase)
+    if book:
+        game_api.load_book(book)
     selection = None
     hint = None
+    # the engine's reply being searched in the background, so the window keeps responding.
+    thinking = None
 
     game_running = True
     
@@ -131,6 +143,8 @@ def handle_game(depth: int=6, color: str="black", delay: float=0.5, flip: bool=F
     
     if color=="white":
         game_api.play()
+    if ponder:
+        game_api.ponder()
 
     while game_running:
         clock.tick(FPS)
@@ -138,22 +152,19 @@ def handle_game(depth: int=6, color: str="black", delay: float=0.5, flip: bool=F
         for event in pygame.event.get():
             if event.type == pygame.QUIT:
                 game_running = False
+                if thinking:
+                    thinking.cancel()
+
+            # the user waits for the engine's move.
+            elif thinking:
+                continue
 
             elif event.type == pygame.MOUSEBUTTONDOWN:
                 if None != selection:
                     selection = game_api.move(*selection, *select(*pygame.mouse.get_pos(), rotation))
                     if None == selection and not game_api.game_over:
                         hint = None
-                        moves, eval = game_api.best_move()
-                        draw(win, game_api, selection, hint, rotation)
-                        pygame.display.update()
-                        # play move by move wait moves a second until the engine is done.
-                        for move in moves:
-                            clock.tick(ticking_time)    
-                            source, dest = move
-                            game_api.move(*source, *dest)
-                            draw(win, game_api, selection, hint, rotation)
-                            pygame.display.update()
+                        thinking = game_api.best_move_async()
 
                 else:  
                     selection = select(*pygame.mouse.get_pos(), rotation)
@@ -161,6 +172,25 @@ def handle_game(depth: int=6, color: str="black", delay: float=0.5, flip: bool=F
                     
             elif event.type == pygame.KEYDOWN and event.key == pygame.K_SPACE:
                 hint = game_api.hint()
+                # the hint stopped the pondering.
+                if ponder:
+                    game_api.ponder()
+
+        if thinking and thinking.done() and not thinking.cancelled():
+            moves, eval = thinking.result()
+            thinking = None
+            draw(win, game_api, selection, hint, rotation)
+            pygame.display.update()
+            # play move by move wait moves a second until the engine is done.
+            for move in moves:
+                clock.tick(ticking_time)    
+                source, dest = move
+                game_api.move(*source, *dest)
+                draw(win, game_api, selection, hint, rotation)
+                pygame.display.update()
+            # the user thinks now, and so does the engine.
+            if ponder:
+                game_api.ponder()
                              
         draw(win, game_api, selection, hint, rotation)
         if game_api.game_over:
@@ -175,19 +205,31 @@ def handle_game(depth: int=6, color: str="black", delay: float=0.5, flip: bool=F
 
     pygame.quit()
     
-def match(black_depth: int=6, white_depth: int=6, delay: float=0.5, flip: bool=False):
+def match(black_depth: int=6, white_depth: int=6, delay: float=0.5, flip: bool=False, time: float=0, threads: int=0, lazy_smp: bool=False, tablebase: str=None, book: str=None):
     """play a match between two engines of set depth
 
     Args:
         black_depth (int, optional): The depth of moves the black engine will look into. Defaults to 6.
         white_depth (int, optional): The depth of moves the white engine will look into. Defaults to 6.
         delay (float, optional): Minimum time between moves, if engine takes more time will not effect waitint time. Defaults to 0.5.
+        time (float, optional): Seconds each engine may think on a move, 0 for no limit. Defaults to 0.
+        threads (int, optional): Threads each engine searches with, 0 for one per hardware thread. Defaults to 0.
+        lazy_smp (bool, optional): Wether the engines' threads search independently sharing only the transposition table. Defaults to False.
+        tablebase (str, optional): Directory of endgame tablebase files for the engines. Defaults to None.
+        book (str, optional): Opening book file for the engines. Defaults to None.
     """
     win = pygame.display.set_mode((WIDTH, HEIGHT))
     pygame.display.set_caption("Checkers")
     clock = pygame.time.Clock()
-    engine_black = Api(black_depth)
-    engine_white = Api(white_depth)
+    parallel_mode = ParallelMode.LAZY_SMP if lazy_smp else ParallelMode.SPLIT
+    engine_black = Api(black_depth, time, threads=threads, parallel_mode=parallel_mode)
+    engine_white = Api(white_depth, time, threads=threads, parallel_mode=parallel_mode)
+    if tablebase:
+        engine_black.load_tablebase(tablebase)
+        engine_white.load_tablebase(tablebase)
+    if book:
+        engine_black.load_book(book)
+        engine_white.load_book(book)
     
     game_running = True
     black_turn = True
@@ -243,15 +285,27 @@ def match(black_depth: int=6, white_depth: int=6, delay: float=0.5, flip: bool=F
 if __name__ == '__main__':
     parser = ArgumentParser()
     parser.add_argument("-m", "--match", help="make the engine play against itself", action="store_true", default=False)
-    parser.add_argument("-d", "--depth", help="The depth of moves the engine will look into, no effect with --match", action="store",type=int, default=6)
-    parser.add_argument("-db", "--depth-black", help="The depth of moves black engine will look into, only effective with --match", action="store",type=int, default=6)
-    parser.add_argument("-dw", "--depth-white", help="The depth of moves white engine will look into, only effective with --match", action="store",type=int, default=6)
+    parser.add_argument("-d", "--depth", help="The depth of moves the engine will look into, no effect with --match", action="store",type=int, default=None)
+    parser.add_argument("-db", "--depth-black", help="The depth of moves black engine will look into, only effective with --match", action="store",type=int, default=None)
+    parser.add_argument("-dw", "--depth-white", help="The depth of moves white engine will look into, only effective with --match", action="store",type=int, default=None)
     parser.add_argument("-dl", "--delay", help="The delay between moves, may be more due to engine computation time", action="store", type=float, default=0.5)
     parser.add_argument("-c", "--color", help="Choose a color to play with", action="store",type=str, default="black")
     parser.add_argument("-f", "--flip", help="Flip the board",  action="store_true", default=False)
+    parser.add_argument("-t", "--time", help="Seconds the engine may think on a move, the depth is then only a maximum (unlimited if not given)", action="store", type=float, default=0)
+    parser.add_argument("-j", "--threads", help="Threads each engine searches with (one per hardware thread if not given)", action="store", type=int, default=0)
+    parser.add_argument("-l", "--lazy-smp", help="Let the engine's threads search independently, sharing only what they found", action="store_true", default=False)
+    parser.add_argument("-tb", "--tablebase", help="Directory of endgame tablebase files built by tbgen", action="store", type=str, default=None)
+    parser.add_argument("-b", "--book", help="Opening book file built by bookgen", action="store", type=str, default=None)
+    parser.add_argument("-p", "--ponder", help="Let the engine think on the user's time, no effect with --match", action="store_true", default=False)
     args = parser.parse_args()
 
+    # with a time limit the engine deepens as far as the time allows unless a depth was asked for explicitly.
+    depth_default = MAX_DEPTH if args.time else 6
+    depth = args.depth if args.depth is not None else depth_default
+    depth_black = args.depth_black if args.depth_black is not None else depth_default
+    depth_white = args.depth_white if args.depth_white is not None else depth_default
+
     if not args.match:
-        handle_game(args.depth, args.color, args.delay, args.flip)
+        handle_game(depth, args.color, args.delay, args.flip, args.time, args.threads, args.lazy_smp, args.tablebase, args.book, args.ponder)
     else:
-        match(args.depth_black, args.depth_white, args.delay, args.flip)
+        match(depth_black, depth_white, args.delay, args.flip, args.time, args.threads, args.lazy_smp, args.tablebase, args.book)
@@ -0,0 +1,341 @@
+#include "engine.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+/**
+ * @brief what one of the two engines of a match may spend on a move.
+ */
+struct Player {
+    SearchLimits limits;
+    std::size_t table_megabytes;
+};
+
+/**
+ * @brief a position a pair of games starts from, once with each engine playing black.
+ */
+struct Opening {
+    BitBoard board;
+    bool black_turn;
+};
+
+/**
+ * @brief the games of a match from the point of view of the first engine, and the statistics derived from them.
+ */
+struct MatchResult {
+    unsigned int wins = 0;
+    unsigned int draws = 0;
+    unsigned int losses = 0;
+
+    unsigned int games() const;
+    double score() const;
+    double elo() const;
+    double elo_error() const;
+    double llr(const double elo0, const double elo1) const;
+};
+
+unsigned int MatchResult::games() const {
+    return this->wins + this->draws + this->losses;
+}
+
+/**
+ * @brief the share of the points the first engine took, between 0 and 1.
+ *
+ * @return double
+ */
+double MatchResult::score() const {
+    return this->games() == 0 ? 0.5 : (this->wins + 0.5 * this->draws) / this->games();
+}
+
+/**
+ * @brief the elo difference of the first engine over the second the score stands for.
+ *
+ * @return double
+ */
+double MatchResult::elo() const {
+    const double score = std::clamp(this->score(), 1e-6, 1 - 1e-6);
+    return -400 * std::log10(1 / score - 1);
+}
+
+/**
+ * @brief the 95% confidence margin of elo, from the variance of the score of a game.
+ *
+ * @return double
+ */
+double MatchResult::elo_error() const {
+    const unsigned int games = this->games();
+    if (games < 2)
+        return INFINITY;
+    const double score = std::clamp(this->score(), 1e-6, 1 - 1e-6);
+    const double variance = (this->wins * std::pow(1 - score, 2) + this->draws * std::pow(0.5 - score, 2) + this->losses * std::pow(score, 2)) / games;
+    // the derivative of elo by the score turns the error of the score into an error in elo.
+    const double slope = 400 / (std::log(10) * score * (1 - score));
+    return 1.96 * std::sqrt(variance / games) * slope;
+}
+
+/**
+ * @brief the log likelihood ratio of the first engine being elo1 stronger than the second against it being elo0 stronger,
+ * with the score of a game taken as normally distributed.
+ *
+ * @param elo0
+ * @param elo1
+ * @return double
+ */
+double MatchResult::llr(const double elo0, const double elo1) const {
+    const unsigned int games = this->games();
+    if (games < 2)
+        return 0;
+    const double score = this->score();
+    const double variance = (this->wins * std::pow(1 - score, 2) + this->draws * std::pow(0.5 - score, 2) + this->losses * std::pow(score, 2)) / games;
+    if (variance <= 0)
+        return 0;
+    const double score0 = 1 / (1 + std::pow(10, -elo0 / 400));
+    const double score1 = 1 / (1 + std::pow(10, -elo1 / 400));
+    return games * (score1 - score0) * (2 * score - score0 - score1) / (2 * variance);
+}
+
+/**
+ * @brief plays a game between black and white from opening, each with an engine of its own and the draw rules of the api.
+ *
+ * @param opening
+ * @param black
+ * @param white
+ * @return int 1 => black won, -1 => white won, 0 => draw.
+ */
+int play_game(const Opening& opening, const Player& black, const Player& white) {
+    Engine engines[] = { Engine(black.table_megabytes, 1), Engine(white.table_megabytes, 1) };
+    const Player* players[] = { &black, &white };
+    BitBoard board = opening.board;
+    bool black_turn = opening.black_turn;
+
+    while (true) {
+        MoveList moves;
+        board.generate(black_turn, moves);
+        // the side to move is stuck and lost.
+        if (moves.empty())
+            return black_turn ? -1 : 1;
+
+        const Player& player = *players[!black_turn];
+        SearchControl control(player.limits);
+        const BitBoard next = engines[!black_turn].best_line(board, black_turn, player.limits, control).best;
+        const bool capture = next.piece_count() != board.piece_count();
+        board = next;
+        black_turn = !black_turn;
+
+        // both engines keep the history of the game, so they know which moves draw.
+        unsigned int repetitions = 0;
+        for (Engine& engine : engines) {
+            if (capture)
+                engine.reset_since_capture();
+            else
+                engine.increment_since_capture();
+            repetitions = engine.increment_position_history_counter(Position(board, black_turn));
+        }
+        if (repetitions >= REPETITION_DRAW || engines[0].get_since_capture() >= NO_CAPTURE_DRAW)
+            return 0;
+    }
+}
+
+/**
+ * @brief an opening of plies random moves from the starting position, random decides them. tries again if the game ended on the way.
+ *
+ * @param plies
+ * @param random
+ * @return Opening
+ */
+Opening random_opening(const unsigned int plies, std::mt19937_64& random) {
+    while (true) {
+        Opening opening{ BitBoard(), true };
+        unsigned int ply = 0;
+        for (; ply < plies; ply++) {
+            MoveList moves;
+            opening.board.generate(opening.black_turn, moves);
+            if (moves.empty())
+                break;
+            opening.board = opening.board.play(opening.black_turn, moves[random() % moves.size()]);
+            opening.black_turn = !opening.black_turn;
+        }
+        if (ply == plies)
+            return opening;
+    }
+}
+
+/**
+ * @brief reads the openings in the file at path, a line per position: its black, white and kings bitboards in hexadecimal and the side to move (b or w).
+ * empty lines and lines starting with # are skipped.
+ *
+ * @param path
+ * @param openings
+ * @return true
+ * @return false if the file could not be read or has a line that is not a position.
+ */
+bool read_openings(const std::string& path, std::vector<Opening>& openings) {
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        uint32_t black, white, kings;
+        std::string turn;
+        if (!(fields >> std::hex >> black >> white >> kings >> turn) || (turn != "b" && turn != "w") || !BitBoard::valid(black, white, kings))
+            return false;
+        openings.push_back(Opening{ BitBoard(black, white, kings), turn == "b" });
+    }
+
+    return !openings.empty();
+}
+
+/**
+ * @brief prints the result of the match so far, and the state of the sprt if one runs.
+ *
+ * @param result
+ * @param sprt
+ * @param elo0
+ * @param elo1
+ * @param bound the llr at which the sprt accepts either hypothesis.
+ */
+void report(const MatchResult& result, const bool sprt, const double elo0, const double elo1, const double bound) {
+    std::cout << "games " << result.games() << ": +" << result.wins << " -" << result.losses << " =" << result.draws
+        << std::fixed << std::setprecision(1) << ", score " << 100 * result.score() << "%, elo " << result.elo() << " +- " << result.elo_error();
+    if (sprt)
+        std::cout << std::setprecision(2) << ", llr " << result.llr(elo0, elo1) << " (" << -bound << ", " << bound << ") [" << elo0 << ", " << elo1 << "]";
+    std::cout << std::endl;
+}
+
+/**
+ * @brief plays games games between engine a and engine b, in pairs from the same opening with the colors switched,
+ * on threads threads at once, and reports the result of a with its elo and, with --sprt, the sequential probability ratio test of elo0 against elo1.
+ * the openings are plies random moves from the starting position, or the positions of the file given with --openings in turn.
+ *
+ * usage: match <games> <depth a> <depth b> [--time <a> <b>] [--nodes <a> <b>] [--table <megabytes>] [--threads <threads>]
+ *              [--openings <file>] [--plies <plies>] [--seed <seed>] [--sprt <elo0> <elo1>]
+ */
+int main(int argc, char** argv) {
+    const std::string usage = " <games> <depth a> <depth b> [--time <a> <b>] [--nodes <a> <b>] [--table <megabytes>] [--threads <threads>] "
+        "[--openings <file>] [--plies <plies>] [--seed <seed>] [--sprt <elo0> <elo1>]";
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0] << usage << std::endl;
+        return 1;
+    }
+
+    const unsigned int games = std::stoul(argv[1]);
+    Player a{ SearchLimits{ (unsigned int)std::stoul(argv[2]), 0, 0 }, 8 };
+    Player b{ SearchLimits{ (unsigned int)std::stoul(argv[3]), 0, 0 }, 8 };
+    unsigned int threads = std::max(std::thread::hardware_concurrency(), 1U);
+    unsigned int plies = 4;
+    uint64_t seed = 1;
+    bool sprt = false;
+    double elo0 = 0, elo1 = 5;
+    std::vector<Opening> openings;
+
+    for (int arg = 4; arg < argc; arg++) {
+        const std::string option = argv[arg];
+        const int values = option == "--time" || option == "--nodes" || option == "--sprt" ? 2 : 1;
+        if (arg + values >= argc) {
+            std::cerr << "usage: " << argv[0] << usage << std::endl;
+            return 1;
+        }
+
+        if (option == "--time") {
+            a.limits.time = std::stod(argv[++arg]);
+            b.limits.time = std::stod(argv[++arg]);
+        }
+        else if (option == "--nodes") {
+            a.limits.nodes = std::stoull(argv[++arg]);
+            b.limits.nodes = std::stoull(argv[++arg]);
+        }
+        else if (option == "--table")
+            a.table_megabytes = b.table_megabytes = std::stoul(argv[++arg]);
+        else if (option == "--threads")
+            threads = std::max(std::stoul(argv[++arg]), 1UL);
+        else if (option == "--openings") {
+            if (!read_openings(argv[++arg], openings)) {
+                std::cerr << "failed to read the openings in " << argv[arg] << std::endl;
+                return 1;
+            }
+        }
+        else if (option == "--plies")
+            plies = std::stoul(argv[++arg]);
+        else if (option == "--seed")
+            seed = std::stoull(argv[++arg]);
+        else if (option == "--sprt") {
+            sprt = true;
+            elo0 = std::stod(argv[++arg]);
+            elo1 = std::stod(argv[++arg]);
+        }
+        else {
+            std::cerr << "usage: " << argv[0] << usage << std::endl;
+            return 1;
+        }
+    }
+
+    for (const Player* player : { &a, &b }) {
+        if (player->limits.depth < 1 || player->limits.depth > MAX_DEPTH) {
+            std::cerr << "depth must be between 1 and " << MAX_DEPTH << std::endl;
+            return 1;
+        }
+    }
+
+    // the sprt stops once the llr passes either bound, both errors are 5%.
+    const double bound = std::log(0.95 / 0.05);
+    const unsigned int pairs = (games + 1) / 2;
+    std::atomic<unsigned int> next = 0;
+    std::atomic<bool> decided = false;
+    // guards result and the output.
+    std::mutex lock;
+    MatchResult result;
+
+    const auto work = [&]() {
+        for (unsigned int pair = next++; pair < pairs && !decided; pair = next++) {
+            std::mt19937_64 random(seed + pair);
+            const Opening opening = openings.empty() ? random_opening(plies, random) : openings[pair % openings.size()];
+
+            // a plays black in the first game of the pair and white in the second.
+            for (unsigned int game = 2 * pair; game < std::min(2 * pair + 2, games); game++) {
+                const bool a_black = game % 2 == 0;
+                const int winner = a_black ? play_game(opening, a, b) : -play_game(opening, b, a);
+
+                const std::lock_guard<std::mutex> guard(lock);
+                if (decided)
+                    return;
+                result.wins += winner == 1;
+                result.draws += winner == 0;
+                result.losses += winner == -1;
+                if (result.games() % 100 == 0)
+                    report(result, sprt, elo0, elo1, bound);
+                if (sprt && std::abs(result.llr(elo0, elo1)) >= bound)
+                    decided = true;
+            }
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned int worker = 1; worker < threads; worker++)
+        workers.emplace_back(work);
+    work();
+    for (auto& worker : workers)
+        worker.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // every hundredth game was reported already.
+    if (result.games() % 100 != 0)
+        report(result, sprt, elo0, elo1, bound);
+    if (sprt) {
+        const double llr = result.llr(elo0, elo1);
+        std::cout << "sprt: " << (llr >= bound ? "H1 accepted, a is stronger by elo1" : llr <= -bound ? "H0 accepted, a is not stronger by elo1" : "undecided") << std::endl;
+    }
+    std::cout << std::fixed << std::setprecision(1) << seconds << "s, " << threads << " threads" << std::endl;
+
+    return 0;
+}
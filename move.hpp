@@ -0,0 +1,91 @@
+#ifndef MOVE_HPP
+#define MOVE_HPP
+
+#include <array>
+#include <cstdint>
+#include "consts.hpp"
+
+/**
+ * @brief a compact record of a single turn: one step, or a whole series of captures by one piece.
+ * squares are bit indexes into the bitboard.
+ */
+struct Move {
+    // all the squares captured along the way.
+    uint32_t captured;
+    // the captured squares that held kings, needed to take the move back.
+    uint32_t captured_kings;
+    uint8_t from;
+    uint8_t to;
+    // was the moving piece crowned during this move.
+    bool promotion;
+    // the diagonal of every jump in order, 2 bits each, one jump per captured square.
+    uint32_t path;
+
+    bool operator==(const Move& other) const {
+        return this->from == other.from && this->to == other.to && this->captured == other.captured;
+    }
+
+    bool operator!=(const Move& other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * @brief a fixed-capacity list of moves that lives wherever it is declared, never touches the heap.
+ */
+class MoveList {
+private:
+    std::array<Move, MAX_MOVES> moves;
+    unsigned int count = 0;
+public:
+    // MAX_MOVES is above the number of legal moves of any position, a move past it is dropped.
+    void push_back(const Move& move) {
+        if (this->count < MAX_MOVES)
+            this->moves[this->count++] = move;
+    }
+
+    void clear() {
+        this->count = 0;
+    }
+
+    unsigned int size() const {
+        return this->count;
+    }
+
+    bool empty() const {
+        return this->count == 0;
+    }
+
+    bool contains(const Move& move) const {
+        for (unsigned int i = 0; i < this->count; i++)
+            if (this->moves[i] == move)
+                return true;
+        return false;
+    }
+
+    Move& operator[](const unsigned int index) {
+        return this->moves[index];
+    }
+
+    const Move& operator[](const unsigned int index) const {
+        return this->moves[index];
+    }
+
+    Move* begin() {
+        return this->moves.data();
+    }
+
+    Move* end() {
+        return this->moves.data() + this->count;
+    }
+
+    const Move* begin() const {
+        return this->moves.data();
+    }
+
+    const Move* end() const {
+        return this->moves.data() + this->count;
+    }
+};
+
+#endif // MOVE_HPP
@@ -0,0 +1,342 @@
+#include "notation.hpp"
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief the number of the square at index of the bitboards in the standard numbering, 1 to 32.
+ * black starts on 1 to 12 and white on 21 to 32, square 1 is the corner of black's back row on white's right.
+ *
+ * @param index
+ * @return unsigned int
+ */
+unsigned int square_number(const unsigned int index) {
+    return NUMBER_OF_REACHABLE_SQUARES - index;
+}
+
+/**
+ * @brief the squares of pieces as the items of a fen, ascending, kings with a K before them.
+ *
+ * @param pieces
+ * @param kings
+ * @return std::string
+ */
+std::string fen_squares(const uint32_t pieces, const uint32_t kings) {
+    std::string result;
+    for (unsigned int number = 1; number <= NUMBER_OF_REACHABLE_SQUARES; number++) {
+        const uint32_t square = 1U << (NUMBER_OF_REACHABLE_SQUARES - number);
+        if (!(pieces & square))
+            continue;
+        if (!result.empty())
+            result += ',';
+        if (kings & square)
+            result += 'K';
+        result += std::to_string(number);
+    }
+    return result;
+}
+
+/**
+ * @brief the position in the standard checkers fen: the side to move, then the squares of the white and of the black pieces.
+ * e.g. B:W21,22,23,24,25,26,27,28,29,30,31,32:B1,2,3,4,5,6,7,8,9,10,11,12 is the starting position.
+ *
+ * @param board
+ * @param black_turn
+ * @return std::string
+ */
+std::string to_fen(const BitBoard& board, const bool black_turn) {
+    return std::string(black_turn ? "B" : "W") + ":W" + fen_squares(board.white_pieces(), board.king_pieces()) + ":B" + fen_squares(board.black_pieces(), board.king_pieces());
+}
+
+/**
+ * @brief reads the squares of a section of a fen into pieces and kings, items are squares or ranges of squares, a K before one makes kings.
+ *
+ * @param section the items separated by commas, may be empty.
+ * @param pieces
+ * @param kings
+ * @param taken the squares of the pieces read so far, no square may hold two.
+ * @return true
+ * @return false
+ */
+bool read_fen_squares(const std::string& section, uint32_t& pieces, uint32_t& kings, uint32_t& taken) {
+    std::size_t position = 0;
+    while (position < section.size()) {
+        std::size_t end = section.find(',', position);
+        if (end == std::string::npos)
+            end = section.size();
+        std::string item = section.substr(position, end - position);
+        position = end + 1;
+
+        const bool king = !item.empty() && (item[0] == 'K' || item[0] == 'k');
+        if (king)
+            item.erase(0, 1);
+
+        const std::size_t dash = item.find('-');
+        const std::string first_text = item.substr(0, dash);
+        const std::string last_text = dash == std::string::npos ? first_text : item.substr(dash + 1);
+        for (const std::string& text : { first_text, last_text })
+            if (text.empty() || text.size() > 2 || !std::all_of(text.begin(), text.end(), [](const char c) { return std::isdigit((unsigned char)c); }))
+                return false;
+
+        const unsigned int first = std::stoul(first_text), last = std::stoul(last_text);
+        if (first < 1 || last > NUMBER_OF_REACHABLE_SQUARES || first > last)
+            return false;
+
+        for (unsigned int number = first; number <= last; number++) {
+            const uint32_t square = 1U << (NUMBER_OF_REACHABLE_SQUARES - number);
+            if (taken & square)
+                return false;
+            taken |= square;
+            pieces |= square;
+            if (king)
+                kings |= square;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief reads a position in the standard checkers fen, see to_fen. the side may be lowercase, spaces and a final dot are ignored.
+ * returns false and leaves board and black_turn as they were if fen is not a position.
+ *
+ * @param fen
+ * @param board
+ * @param black_turn
+ * @return true
+ * @return false
+ */
+bool from_fen(const std::string& fen, BitBoard& board, bool& black_turn) {
+    std::string text;
+    for (const char c : fen)
+        if (!std::isspace((unsigned char)c))
+            text += c;
+    if (!text.empty() && text.back() == '.')
+        text.pop_back();
+
+    std::vector<std::string> sections;
+    std::size_t position = 0;
+    while (true) {
+        const std::size_t end = text.find(':', position);
+        sections.push_back(text.substr(position, end == std::string::npos ? std::string::npos : end - position));
+        if (end == std::string::npos)
+            break;
+        position = end + 1;
+    }
+
+    if (sections.size() > 3 || sections[0].size() != 1 || (std::toupper(sections[0][0]) != 'B' && std::toupper(sections[0][0]) != 'W'))
+        return false;
+
+    uint32_t black = 0, white = 0, kings = 0, taken = 0;
+    bool seen_black = false, seen_white = false;
+    for (unsigned int i = 1; i < sections.size(); i++) {
+        if (sections[i].empty())
+            return false;
+        const char color = std::toupper(sections[i][0]);
+        bool& seen = color == 'B' ? seen_black : seen_white;
+        if ((color != 'B' && color != 'W') || seen)
+            return false;
+        seen = true;
+        if (!read_fen_squares(sections[i].substr(1), color == 'B' ? black : white, kings, taken))
+            return false;
+    }
+
+    if (!BitBoard::valid(black, white, kings))
+        return false;
+
+    board = BitBoard(black, white, kings);
+    black_turn = std::toupper(sections[0][0]) == 'B';
+    return true;
+}
+
+/**
+ * @brief writes the record of the position to record, POSITION_RECORD_SIZE bytes.
+ *
+ * @param board
+ * @param black_turn
+ * @param record
+ */
+void to_record(const BitBoard& board, const bool black_turn, uint8_t* record) {
+    const uint32_t words[] = { board.black_pieces(), board.white_pieces(), board.king_pieces() };
+    for (unsigned int word = 0; word < 3; word++)
+        for (unsigned int byte = 0; byte < 4; byte++)
+            record[4 * word + byte] = words[word] >> (8 * byte);
+    record[12] = black_turn;
+}
+
+/**
+ * @brief reads the position in the POSITION_RECORD_SIZE bytes at record, returns false and leaves board and black_turn as they were if it is not a position.
+ *
+ * @param record
+ * @param board
+ * @param black_turn
+ * @return true
+ * @return false
+ */
+bool from_record(const uint8_t* record, BitBoard& board, bool& black_turn) {
+    uint32_t words[3] = {};
+    for (unsigned int word = 0; word < 3; word++)
+        for (unsigned int byte = 0; byte < 4; byte++)
+            words[word] |= (uint32_t)record[4 * word + byte] << (8 * byte);
+
+    const auto [black, white, kings] = words;
+    if (!BitBoard::valid(black, white, kings) || record[12] > 1)
+        return false;
+
+    board = BitBoard(black, white, kings);
+    black_turn = record[12];
+    return true;
+}
+
+PositionReader::PositionReader() : records(nullptr), count(0), length(0), mapping(nullptr) {}
+
+PositionReader::~PositionReader() {
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->length);
+}
+
+/**
+ * @brief maps the file of records at path, returns false if it is not a whole number of records.
+ *
+ * @param path
+ * @return true
+ * @return false
+ */
+bool PositionReader::load(const std::string& path) {
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    const bool complete = fstat(file, &status) == 0 && status.st_size % POSITION_RECORD_SIZE == 0;
+    if (complete && status.st_size > 0)
+        mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    // the mapping stays valid after the file is closed.
+    close(file);
+
+    // an empty file has no records to map.
+    if (!complete || (status.st_size > 0 && mapping == MAP_FAILED))
+        return false;
+    if (status.st_size > 0)
+        madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->length);
+    this->mapping = status.st_size > 0 ? mapping : nullptr;
+    this->length = status.st_size;
+    this->count = status.st_size / POSITION_RECORD_SIZE;
+    this->records = (const uint8_t*)this->mapping;
+
+    return true;
+}
+
+/**
+ * @brief the number of records in the file.
+ *
+ * @return std::size_t
+ */
+std::size_t PositionReader::size() const {
+    return this->count;
+}
+
+/**
+ * @brief reads the position of record index, returns false if index is past the end or the record is not a position.
+ *
+ * @param index
+ * @param board
+ * @param black_turn
+ * @return true
+ * @return false
+ */
+bool PositionReader::get(const std::size_t index, BitBoard& board, bool& black_turn) const {
+    return index < this->count && from_record(this->record(index), board, black_turn);
+}
+
+/**
+ * @brief the bytes of record index, the records follow each other.
+ *
+ * @param index
+ * @return const uint8_t*
+ */
+const uint8_t* PositionReader::record(const std::size_t index) const {
+    return this->records + index * POSITION_RECORD_SIZE;
+}
+
+PositionWriter::PositionWriter() : count(0) {
+    this->buffer.reserve(POSITION_WRITER_BUFFER * POSITION_RECORD_SIZE);
+}
+
+PositionWriter::~PositionWriter() {
+    this->close();
+}
+
+/**
+ * @brief opens the file at path to write records to, after the records already in it if append.
+ *
+ * @param path
+ * @param append
+ * @return true
+ * @return false
+ */
+bool PositionWriter::open(const std::string& path, const bool append) {
+    this->close();
+    this->file.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    this->count = 0;
+    return this->file.is_open();
+}
+
+/**
+ * @brief adds the record of the position, the records reach the file once the buffer is full, or on flush or close.
+ *
+ * @param board
+ * @param black_turn
+ */
+void PositionWriter::write(const BitBoard& board, const bool black_turn) {
+    const std::size_t end = this->buffer.size();
+    this->buffer.resize(end + POSITION_RECORD_SIZE);
+    to_record(board, black_turn, this->buffer.data() + end);
+    this->count++;
+
+    if (this->buffer.size() >= POSITION_WRITER_BUFFER * POSITION_RECORD_SIZE)
+        this->flush();
+}
+
+/**
+ * @brief writes the buffered records to the file, returns false if writing failed.
+ *
+ * @return true
+ * @return false
+ */
+bool PositionWriter::flush() {
+    if (!this->file.is_open())
+        return false;
+    this->file.write((const char*)this->buffer.data(), this->buffer.size());
+    this->buffer.clear();
+    this->file.flush();
+    return (bool)this->file;
+}
+
+/**
+ * @brief writes the buffered records and closes the file, returns false if writing failed.
+ *
+ * @return true
+ * @return false
+ */
+bool PositionWriter::close() {
+    if (!this->file.is_open())
+        return true;
+    const bool written = this->flush();
+    this->file.close();
+    return written;
+}
+
+/**
+ * @brief the number of records written since the file was opened.
+ *
+ * @return std::size_t
+ */
+std::size_t PositionWriter::size() const {
+    return this->count;
+}
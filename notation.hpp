@@ -0,0 +1,67 @@
+#ifndef NOTATION_HPP
+#define NOTATION_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include "consts.hpp"
+#include "bitboard.hpp"
+
+// size of a position record: the black, white and kings bitboards as little endian 32 bit words, then the side to move (1 => black).
+constexpr std::size_t POSITION_RECORD_SIZE = 13;
+// records a position writer collects before writing them to its file.
+constexpr std::size_t POSITION_WRITER_BUFFER = 1 << 16;
+
+unsigned int square_number(const unsigned int index);
+std::string to_fen(const BitBoard& board, const bool black_turn);
+bool from_fen(const std::string& fen, BitBoard& board, bool& black_turn);
+void to_record(const BitBoard& board, const bool black_turn, uint8_t* record);
+bool from_record(const uint8_t* record, BitBoard& board, bool& black_turn);
+
+/**
+ * @brief read only access to a file of position records, the file is memory mapped so it is never loaded as a whole.
+ */
+class PositionReader {
+private:
+    const uint8_t* records;
+    std::size_t count;
+    std::size_t length;
+    void* mapping;
+
+public:
+    PositionReader();
+    ~PositionReader();
+    PositionReader(const PositionReader&) = delete;
+    PositionReader& operator=(const PositionReader&) = delete;
+
+    bool load(const std::string& path);
+    std::size_t size() const;
+    bool get(const std::size_t index, BitBoard& board, bool& black_turn) const;
+    const uint8_t* record(const std::size_t index) const;
+};
+
+/**
+ * @brief appends position records to a file, a buffer of them at a time.
+ */
+class PositionWriter {
+private:
+    std::ofstream file;
+    std::vector<uint8_t> buffer;
+    std::size_t count;
+
+public:
+    PositionWriter();
+    ~PositionWriter();
+    PositionWriter(const PositionWriter&) = delete;
+    PositionWriter& operator=(const PositionWriter&) = delete;
+
+    bool open(const std::string& path, const bool append = false);
+    void write(const BitBoard& board, const bool black_turn);
+    bool flush();
+    bool close();
+    std::size_t size() const;
+};
+
+#endif // NOTATION_HPP
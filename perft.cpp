@@ -0,0 +1,73 @@
+#include "perft.hpp"
+#include <execution>
+#include <algorithm>
+
+/**
+ * @brief counts the positions reached after depth full moves (a capture series is one move) from board.
+ * the moves of the last ply are only counted, never played.
+ *
+ * @param board played on and restored.
+ * @param black_turn
+ * @param depth
+ * @return uint64_t
+ */
+uint64_t perft(BitBoard& board, const bool black_turn, const unsigned int depth) {
+    if (depth == 0)
+        return 1;
+
+    MoveList moves;
+    board.generate(black_turn, moves);
+    if (depth == 1)
+        return moves.size();
+
+    uint64_t nodes = 0;
+    for (const auto& move : moves) {
+        board.make(black_turn, move);
+        nodes += perft(board, !black_turn, depth - 1);
+        board.unmake(black_turn, move);
+    }
+
+    return nodes;
+}
+
+/**
+ * @brief perft of every move from board, the moves are counted in parallel.
+ *
+ * @param board
+ * @param black_turn
+ * @param depth at least 1.
+ * @return std::vector<std::pair<Move, uint64_t>> every move with the positions reached after it.
+ */
+std::vector<std::pair<Move, uint64_t>> divide(const BitBoard& board, const bool black_turn, const unsigned int depth) {
+    MoveList moves;
+    board.generate(black_turn, moves);
+
+    std::vector<std::pair<Move, uint64_t>> result(moves.size());
+    std::for_each(std::execution::par, moves.begin(), moves.end(), [&](const Move& move) {
+        BitBoard child = board.play(black_turn, move);
+        result[&move - moves.begin()] = std::pair(move, perft(child, !black_turn, depth - 1));
+    });
+
+    return result;
+}
+
+/**
+ * @brief perft of board, the moves from it are counted in parallel.
+ *
+ * @param board
+ * @param black_turn
+ * @param depth
+ * @return uint64_t
+ */
+uint64_t parallel_perft(const BitBoard& board, const bool black_turn, const unsigned int depth) {
+    if (depth <= 1) {
+        BitBoard copy(board);
+        return perft(copy, black_turn, depth);
+    }
+
+    uint64_t nodes = 0;
+    for (const auto& [move, count] : divide(board, black_turn, depth))
+        nodes += count;
+
+    return nodes;
+}
@@ -0,0 +1,15 @@
+#ifndef PERFT_HPP
+#define PERFT_HPP
+
+#include <vector>
+#include <tuple>
+#include <cstdint>
+#include "consts.hpp"
+#include "move.hpp"
+#include "bitboard.hpp"
+
+uint64_t perft(BitBoard& board, const bool black_turn, const unsigned int depth);
+std::vector<std::pair<Move, uint64_t>> divide(const BitBoard& board, const bool black_turn, const unsigned int depth);
+uint64_t parallel_perft(const BitBoard& board, const bool black_turn, const unsigned int depth);
+
+#endif // PERFT_HPP
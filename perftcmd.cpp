@@ -0,0 +1,57 @@
+#include "perft.hpp"
+#include <chrono>
+#include <cstring>
+
+/**
+ * @brief counts the positions reached from a position to every depth up to depth, and the speed of counting them.
+ * with --divide only depth is counted, and the count after every move is printed too.
+ * the position is given by the bitboards of the black pieces, the white pieces and the kings in hexadecimal and the side to move (b or w),
+ * without it the starting position is counted.
+ *
+ * usage: perft <depth> [--divide] [<black> <white> <kings> <b|w>]
+ */
+int main(int argc, char** argv) {
+    int arg = 1;
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <depth> [--divide] [<black> <white> <kings> <b|w>]" << std::endl;
+        return 1;
+    }
+
+    const unsigned int depth = std::stoul(argv[arg++]);
+    const bool split = arg < argc && std::strcmp(argv[arg], "--divide") == 0;
+    arg += split;
+
+    BitBoard board;
+    bool black_turn = true;
+    if (arg + 4 <= argc) {
+        board = BitBoard(std::stoul(argv[arg], nullptr, 16), std::stoul(argv[arg + 1], nullptr, 16), std::stoul(argv[arg + 2], nullptr, 16));
+        black_turn = argv[arg + 3][0] == 'b';
+    }
+    else if (arg != argc) {
+        std::cerr << "a position needs the black, white and kings bitboards and the side to move" << std::endl;
+        return 1;
+    }
+
+    std::cout << board << std::endl;
+
+    for (unsigned int current = split ? depth : 1; current <= depth; current++) {
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = 0;
+
+        if (split) {
+            for (const auto& [move, count] : divide(board, black_turn, current)) {
+                const auto [from_x, from_y] = board_index_to_xy(move.from);
+                const auto [to_x, to_y] = board_index_to_xy(move.to);
+                std::cout << "(" << from_x << ", " << from_y << ") -> (" << to_x << ", " << to_y << "): " << count << std::endl;
+                nodes += count;
+            }
+        }
+        else
+            nodes = parallel_perft(board, black_turn, current);
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "depth " << current << ": " << nodes << " nodes, " << seconds << "s, " << (uint64_t)(nodes / std::max(seconds, 1e-9)) << " nodes/s" << std::endl;
+    }
+
+    return 0;
+}
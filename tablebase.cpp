@@ -0,0 +1,298 @@
+#include "tablebase.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// a man on its promotion row would have been crowned, so men only stand on the other 28 squares.
+constexpr uint32_t BLACK_MEN_SQUARES = ~BLACK_PROMOTION_ROW;
+constexpr uint32_t WHITE_MEN_SQUARES = ~WHITE_PROMOTION_ROW;
+constexpr unsigned int MATERIAL_BASE = MAX_TABLEBASE_PIECES + 1;
+
+typedef std::array<std::array<uint64_t, NUMBER_OF_REACHABLE_SQUARES + 1>, NUMBER_OF_REACHABLE_SQUARES + 1> BinomialTable;
+
+constexpr BinomialTable make_binomials() {
+    BinomialTable binomials{};
+    for (unsigned int n = 0; n <= NUMBER_OF_REACHABLE_SQUARES; n++) {
+        binomials[n][0] = 1;
+        for (unsigned int k = 1; k <= n; k++)
+            binomials[n][k] = binomials[n - 1][k - 1] + (k < n ? binomials[n - 1][k] : 0);
+    }
+    return binomials;
+}
+
+// BINOMIAL[n][k] => the number of ways to choose k squares out of n.
+constexpr BinomialTable BINOMIAL = make_binomials();
+
+/**
+ * @brief the rank of squares among all the sets of the same size of the squares in mask, squares must be a subset of mask.
+ *
+ * @param squares
+ * @param mask
+ * @return uint64_t
+ */
+uint64_t rank_squares(const uint32_t squares, const uint32_t mask) {
+    uint64_t rank = 0;
+    unsigned int position = 0;
+    unsigned int chosen = 0;
+
+    for (uint32_t bits = mask; bits != 0; bits &= bits - 1, position++)
+        if (squares & bits & -bits)
+            rank += BINOMIAL[position][++chosen];
+
+    return rank;
+}
+
+/**
+ * @brief the set of count squares of mask with rank, the inverse of rank_squares.
+ *
+ * @param rank
+ * @param count
+ * @param mask
+ * @return uint32_t
+ */
+uint32_t unrank_squares(uint64_t rank, const unsigned int count, const uint32_t mask) {
+    std::array<uint32_t, NUMBER_OF_REACHABLE_SQUARES> squares;
+    unsigned int available = 0;
+    for (uint32_t bits = mask; bits != 0; bits &= bits - 1)
+        squares[available++] = bits & -bits;
+
+    uint32_t result = 0;
+    for (unsigned int k = count; k > 0; k--) {
+        // the k-th square is the highest one whose binomial still fits in the rank.
+        unsigned int position = available - 1;
+        while (BINOMIAL[position][k] > rank)
+            position--;
+
+        result |= squares[position];
+        rank -= BINOMIAL[position][k];
+        available = position;
+    }
+
+    return result;
+}
+
+Material Material::of(const BitBoard& board) {
+    const uint32_t kings = board.king_pieces();
+    return Material{
+        (uint8_t)std::popcount(board.black_pieces() & ~kings),
+        (uint8_t)std::popcount(board.black_pieces() & kings),
+        (uint8_t)std::popcount(board.white_pieces() & ~kings),
+        (uint8_t)std::popcount(board.white_pieces() & kings)
+    };
+}
+
+unsigned int Material::pieces() const {
+    return this->black_men + this->black_kings + this->white_men + this->white_kings;
+}
+
+/**
+ * @brief a unique number for every material with up to MAX_TABLEBASE_PIECES of each kind of piece.
+ *
+ * @return unsigned int
+ */
+unsigned int Material::code() const {
+    return ((this->black_men * MATERIAL_BASE + this->black_kings) * MATERIAL_BASE + this->white_men) * MATERIAL_BASE + this->white_kings;
+}
+
+/**
+ * @brief the number of positions with this material, not counting the side to move.
+ * the men of each color are placed first, each on its own 28 squares, then the black kings and then the white kings on the squares left,
+ * placements of men of both colors on the same square are invalid positions.
+ *
+ * @return uint64_t
+ */
+uint64_t Material::positions() const {
+    const unsigned int free = NUMBER_OF_REACHABLE_SQUARES - this->black_men - this->white_men;
+    return BINOMIAL[std::popcount(BLACK_MEN_SQUARES)][this->black_men] * BINOMIAL[std::popcount(WHITE_MEN_SQUARES)][this->white_men]
+        * BINOMIAL[free][this->black_kings] * BINOMIAL[free - this->black_kings][this->white_kings];
+}
+
+std::string Material::file_name() const {
+    return std::to_string(this->black_men) + std::to_string(this->black_kings) + std::to_string(this->white_men) + std::to_string(this->white_kings) + ".tb";
+}
+
+bool Material::operator==(const Material& other) const {
+    return this->code() == other.code();
+}
+
+/**
+ * @brief the index of board among the positions of material, board must have exactly material.
+ *
+ * @param board
+ * @param material
+ * @return uint64_t
+ */
+uint64_t tablebase_index(const BitBoard& board, const Material& material) {
+    const uint32_t kings = board.king_pieces();
+    const uint32_t black_men = board.black_pieces() & ~kings;
+    const uint32_t white_men = board.white_pieces() & ~kings;
+    const uint32_t free = ~(black_men | white_men);
+    const uint32_t black_kings = board.black_pieces() & kings;
+    const unsigned int free_count = NUMBER_OF_REACHABLE_SQUARES - material.black_men - material.white_men;
+
+    uint64_t index = rank_squares(black_men, BLACK_MEN_SQUARES);
+    index = index * BINOMIAL[std::popcount(WHITE_MEN_SQUARES)][material.white_men] + rank_squares(white_men, WHITE_MEN_SQUARES);
+    index = index * BINOMIAL[free_count][material.black_kings] + rank_squares(black_kings, free);
+    index = index * BINOMIAL[free_count - material.black_kings][material.white_kings] + rank_squares(board.white_pieces() & kings, free & ~black_kings);
+
+    return index;
+}
+
+/**
+ * @brief sets board to the position at index among the positions of material, the inverse of tablebase_index.
+ * returns false if the index is of an invalid position.
+ *
+ * @param material
+ * @param index
+ * @param board
+ * @return true
+ * @return false
+ */
+bool tablebase_position(const Material& material, uint64_t index, BitBoard& board) {
+    const unsigned int free_count = NUMBER_OF_REACHABLE_SQUARES - material.black_men - material.white_men;
+    const uint64_t white_kings_count = BINOMIAL[free_count - material.black_kings][material.white_kings];
+    const uint64_t black_kings_count = BINOMIAL[free_count][material.black_kings];
+    const uint64_t white_men_count = BINOMIAL[std::popcount(WHITE_MEN_SQUARES)][material.white_men];
+
+    const uint64_t white_kings_rank = index % white_kings_count;
+    index /= white_kings_count;
+    const uint64_t black_kings_rank = index % black_kings_count;
+    index /= black_kings_count;
+    const uint64_t white_men_rank = index % white_men_count;
+    index /= white_men_count;
+
+    const uint32_t black_men = unrank_squares(index, material.black_men, BLACK_MEN_SQUARES);
+    const uint32_t white_men = unrank_squares(white_men_rank, material.white_men, WHITE_MEN_SQUARES);
+    if (black_men & white_men)
+        return false;
+
+    const uint32_t free = ~(black_men | white_men);
+    const uint32_t black_kings = unrank_squares(black_kings_rank, material.black_kings, free);
+    const uint32_t white_kings = unrank_squares(white_kings_rank, material.white_kings, free & ~black_kings);
+
+    board = BitBoard(black_men | black_kings, white_men | white_kings, black_kings | white_kings);
+    return true;
+}
+
+Tablebase::Tablebase() : mappings(), pieces(0) {}
+
+Tablebase::~Tablebase() {
+    for (auto& mapping : this->mappings)
+        if (mapping.values != nullptr)
+            munmap((void*)mapping.values, mapping.length);
+}
+
+/**
+ * @brief maps every file of the tablebase found in directory, returns the number of files mapped.
+ *
+ * @param directory
+ * @return unsigned int
+ */
+unsigned int Tablebase::load(const std::string& directory) {
+    unsigned int loaded = 0;
+
+    for (unsigned int black_men = 0; black_men <= MAX_TABLEBASE_PIECES; black_men++)
+        for (unsigned int black_kings = 0; black_men + black_kings <= MAX_TABLEBASE_PIECES; black_kings++)
+            for (unsigned int white_men = 0; black_men + black_kings + white_men <= MAX_TABLEBASE_PIECES; white_men++)
+                for (unsigned int white_kings = 0; black_men + black_kings + white_men + white_kings <= MAX_TABLEBASE_PIECES; white_kings++)
+                    loaded += this->load(directory, Material{ (uint8_t)black_men, (uint8_t)black_kings, (uint8_t)white_men, (uint8_t)white_kings });
+
+    return loaded;
+}
+
+/**
+ * @brief maps the file of material in directory, returns false if there is no complete file for it.
+ *
+ * @param directory
+ * @param material
+ * @return true
+ * @return false
+ */
+bool Tablebase::load(const std::string& directory, const Material& material) {
+    if (material.pieces() > MAX_TABLEBASE_PIECES || material.black_men + material.black_kings == 0 || material.white_men + material.white_kings == 0)
+        return false;
+
+    const int file = open((directory + "/" + material.file_name()).c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    const std::size_t length = 2 * material.positions();
+    void* values = MAP_FAILED;
+    if (fstat(file, &status) == 0 && (std::size_t)status.st_size == length)
+        values = mmap(nullptr, length, PROT_READ, MAP_SHARED, file, 0);
+    // the mapping stays valid after the file is closed.
+    close(file);
+
+    if (values == MAP_FAILED)
+        return false;
+    madvise(values, length, MADV_RANDOM);
+
+    Mapping& mapping = this->mappings[material.code()];
+    if (mapping.values != nullptr)
+        munmap((void*)mapping.values, mapping.length);
+    mapping.values = (const uint8_t*)values;
+    mapping.length = length;
+    this->pieces = std::max(this->pieces, material.pieces());
+
+    return true;
+}
+
+/**
+ * @brief the most pieces of a position that may be in the tablebase.
+ *
+ * @return unsigned int
+ */
+unsigned int Tablebase::max_pieces() const {
+    return this->pieces;
+}
+
+bool Tablebase::contains(const Material& material) const {
+    return material.pieces() <= MAX_TABLEBASE_PIECES && this->mappings[material.code()].values != nullptr;
+}
+
+/**
+ * @brief the raw value of entry in the file of material, entry = 2 * index + (white to move), the file must be loaded.
+ *
+ * @param material
+ * @param entry
+ * @return uint8_t
+ */
+uint8_t Tablebase::value(const Material& material, const uint64_t entry) const {
+    return this->mappings[material.code()].values[entry];
+}
+
+/**
+ * @brief looks board up in the tablebase, returns true and sets score if it is there.
+ * the score is 0 for a draw, and a win is worth TABLEBASE_WIN less the plies it takes, positive is good for white.
+ *
+ * @param board
+ * @param black_turn
+ * @param score
+ * @return true
+ * @return false
+ */
+bool Tablebase::probe(const BitBoard& board, const bool black_turn, short& score) const {
+    if ((unsigned int)board.piece_count() > this->pieces)
+        return false;
+
+    const Material material = Material::of(board);
+    if (!this->contains(material))
+        return false;
+
+    const uint8_t value = this->value(material, 2 * tablebase_index(board, material) + !black_turn);
+    if (value == TABLEBASE_INVALID)
+        return false;
+
+    if (value == TABLEBASE_DRAW) {
+        score = 0;
+        return true;
+    }
+
+    // good for the side to move.
+    const short plies = value - 1;
+    const short own = (value & 1) ? plies - TABLEBASE_WIN : TABLEBASE_WIN - plies;
+    score = black_turn ? -own : own;
+    return true;
+}
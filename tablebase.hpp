@@ -0,0 +1,67 @@
+#ifndef TABLEBASE_HPP
+#define TABLEBASE_HPP
+
+#include <array>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "consts.hpp"
+#include "bitboard.hpp"
+
+// value of a position in a tablebase file, otherwise plies to the end of the game + 1: odd => the side to move loses, even => it wins.
+constexpr uint8_t TABLEBASE_DRAW = 0;
+constexpr uint8_t TABLEBASE_INVALID = 255;
+// longest distance a file can hold, longer wins and losses are stored as these.
+constexpr uint8_t TABLEBASE_FAR_LOSS = 253;
+constexpr uint8_t TABLEBASE_FAR_WIN = 254;
+
+/**
+ * @brief the number of pieces of each kind on the board, every material has a file of its own in the tablebase.
+ */
+struct Material {
+    uint8_t black_men;
+    uint8_t black_kings;
+    uint8_t white_men;
+    uint8_t white_kings;
+
+    static Material of(const BitBoard& board);
+    unsigned int pieces() const;
+    unsigned int code() const;
+    uint64_t positions() const;
+    std::string file_name() const;
+    bool operator==(const Material& other) const;
+};
+
+uint64_t tablebase_index(const BitBoard& board, const Material& material);
+bool tablebase_position(const Material& material, uint64_t index, BitBoard& board);
+
+/**
+ * @brief read only access to the files of the tablebase, every file is memory mapped so probing is a single memory read.
+ * a file holds one byte per position of its material, the positions with black to move and white to move alternate.
+ */
+class Tablebase {
+private:
+    struct Mapping {
+        const uint8_t* values = nullptr;
+        std::size_t length = 0;
+    };
+
+    // indexed by Material::code.
+    std::array<Mapping, (MAX_TABLEBASE_PIECES + 1) * (MAX_TABLEBASE_PIECES + 1) * (MAX_TABLEBASE_PIECES + 1) * (MAX_TABLEBASE_PIECES + 1)> mappings;
+    unsigned int pieces;
+
+public:
+    Tablebase();
+    ~Tablebase();
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+
+    unsigned int load(const std::string& directory);
+    bool load(const std::string& directory, const Material& material);
+    unsigned int max_pieces() const;
+    uint8_t value(const Material& material, const uint64_t entry) const;
+    bool contains(const Material& material) const;
+    bool probe(const BitBoard& board, const bool black_turn, short& score) const;
+};
+
+#endif // TABLEBASE_HPP
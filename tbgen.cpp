@@ -0,0 +1,288 @@
+#include "tablebase.hpp"
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+
+// positions a thread takes at once from the ones left in a round.
+constexpr uint64_t POSITIONS_PER_TASK = 4096;
+
+/**
+ * @brief runs task on every index in [0, count) with threads threads.
+ *
+ * @param threads
+ * @param count
+ * @param task
+ */
+template <typename Task>
+void for_each_index(const unsigned int threads, const uint64_t count, const Task& task) {
+    std::atomic<uint64_t> next(0);
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 0; i < threads; i++) {
+        workers.emplace_back([&]() {
+            for (uint64_t first = next.fetch_add(POSITIONS_PER_TASK); first < count; first = next.fetch_add(POSITIONS_PER_TASK))
+                for (uint64_t index = first; index < std::min(first + POSITIONS_PER_TASK, count); index++)
+                    task(index);
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+/**
+ * @brief checks that every material a position of material can turn into is already in the tablebase.
+ * pieces are never added and men never come back, so these are all the smaller materials of each color.
+ *
+ * @param tablebase
+ * @param material
+ * @return true
+ * @return false
+ */
+bool dependencies_loaded(const Tablebase& tablebase, const Material& material) {
+    for (uint8_t black_men = 0; black_men <= material.black_men; black_men++)
+        for (uint8_t black_kings = 0; black_men + black_kings <= material.black_men + material.black_kings; black_kings++)
+            for (uint8_t white_men = 0; white_men <= material.white_men; white_men++)
+                for (uint8_t white_kings = 0; white_men + white_kings <= material.white_men + material.white_kings; white_kings++) {
+                    const Material smaller{ black_men, black_kings, white_men, white_kings };
+                    if (!(smaller == material) && black_men + black_kings != 0 && white_men + white_kings != 0 && !tablebase.contains(smaller)) {
+                        std::cerr << "missing " << smaller.file_name() << " needed by " << material.file_name() << std::endl;
+                        return false;
+                    }
+                }
+
+    return true;
+}
+
+/**
+ * @brief the value of the position after a move, for the side to move in it.
+ * positions of material are read from values, which other threads may be writing, the rest come from the tablebase.
+ *
+ * @param tablebase
+ * @param material
+ * @param values
+ * @param board
+ * @param black_turn
+ * @return uint8_t
+ */
+uint8_t child_value(const Tablebase& tablebase, const Material& material, std::vector<uint8_t>& values, const BitBoard& board, const bool black_turn) {
+    // no pieces left to move is a loss.
+    if ((black_turn ? board.num_black() : board.num_white()) == 0)
+        return 1;
+
+    const Material child = Material::of(board);
+    const uint64_t entry = 2 * tablebase_index(board, child) + !black_turn;
+
+    if (child == material)
+        return std::atomic_ref<uint8_t>(values[entry]).load(std::memory_order_relaxed);
+    return tablebase.value(child, entry);
+}
+
+/**
+ * @brief retrograde analysis of all the positions of material, fills values with the content of its file.
+ * first the positions without moves are lost, then every round r decides the positions that are won or lost in r plies:
+ * won if a move leads to a position lost in r - 1 plies, lost if every move leads to a position won and the longest win takes r - 1 plies.
+ * once the distances do not fit in a byte the rounds keep deciding wins and losses without them.
+ * the positions never decided are draws.
+ * only the first round and the first round without distances look at every position, the others look at the positions a step back
+ * from the ones decided in the round before, and at the positions with a move out of the material to a distance of the round.
+ *
+ * @param tablebase the smaller materials.
+ * @param material
+ * @param threads
+ * @param values
+ * @return unsigned int the number of rounds.
+ */
+unsigned int solve(const Tablebase& tablebase, const Material& material, const unsigned int threads, std::vector<uint8_t>& values) {
+    const uint64_t positions = material.positions();
+    values.assign(2 * positions, TABLEBASE_DRAW);
+    // pending[entry] => the position is looked at in this round, next[entry] => in the next one.
+    std::vector<uint8_t> pending(2 * positions, 0);
+    std::vector<uint8_t> next(2 * positions, 0);
+    // wake[entry] => the next round a move out of the material of the position can decide it in, 0 => none.
+    std::vector<uint8_t> wake(2 * positions, 0);
+
+    for_each_index(threads, positions, [&](const uint64_t index) {
+        BitBoard board;
+        MoveList moves;
+
+        if (!tablebase_position(material, index, board)) {
+            values[2 * index] = values[2 * index + 1] = TABLEBASE_INVALID;
+            return;
+        }
+
+        for (const bool black_turn : { true, false }) {
+            board.generate(black_turn, moves);
+            if (moves.empty())
+                values[2 * index + !black_turn] = 1;
+        }
+    });
+
+    std::atomic<uint8_t> longest_outside(0);
+    unsigned int round = 1;
+    for (;; round++) {
+        const bool far = round >= TABLEBASE_FAR_LOSS;
+        const bool full = round == 1 || round == TABLEBASE_FAR_LOSS;
+        std::atomic<bool> changed(false);
+
+        for_each_index(threads, positions, [&](const uint64_t index) {
+            BitBoard board;
+            MoveList moves;
+            bool placed = false;
+
+            for (const bool black_turn : { true, false }) {
+                const uint64_t entry = 2 * index + !black_turn;
+                std::atomic_ref<uint8_t> value(values[entry]);
+                if (value.load(std::memory_order_relaxed) != TABLEBASE_DRAW || !(full || pending[entry] || wake[entry] == round))
+                    continue;
+                if (!placed) {
+                    tablebase_position(material, index, board);
+                    placed = true;
+                }
+
+                bool win = false;
+                bool all_lost = true;
+                uint8_t longest = 0;
+                uint8_t soonest_outside = 0;
+                board.generate(black_turn, moves);
+
+                for (const auto& move : moves) {
+                    const BitBoard child = board.play(black_turn, move);
+                    const uint8_t result = child_value(tablebase, material, values, child, !black_turn);
+
+                    if (!(Material::of(child) == material)) {
+                        uint8_t seen = longest_outside.load(std::memory_order_relaxed);
+                        while (result > seen && !longest_outside.compare_exchange_weak(seen, result, std::memory_order_relaxed));
+                        if (result > round && (soonest_outside == 0 || result < soonest_outside))
+                            soonest_outside = result;
+                    }
+
+                    // undecided yet, or a draw.
+                    if (result == TABLEBASE_DRAW)
+                        all_lost = false;
+                    // the other side loses.
+                    else if (result & 1) {
+                        all_lost = false;
+                        win = win || far || result == round;
+                    }
+                    else
+                        longest = std::max(longest, result);
+                }
+
+                if (win)
+                    value.store(far ? TABLEBASE_FAR_WIN : round + 1, std::memory_order_relaxed);
+                else if (all_lost && (far || longest == round))
+                    value.store(far ? TABLEBASE_FAR_LOSS : round + 1, std::memory_order_relaxed);
+                else {
+                    wake[entry] = soonest_outside;
+                    continue;
+                }
+                changed.store(true, std::memory_order_relaxed);
+
+                // the positions a step back are the only ones in the material the decision can decide next.
+                for (const BitBoard& previous : board.steps_back(!black_turn))
+                    std::atomic_ref<uint8_t>(next[2 * tablebase_index(previous, material) + black_turn]).store(1, std::memory_order_relaxed);
+            }
+        });
+
+        // nothing can be decided in the following rounds unless a position outside the material still has a longer distance.
+        if (!changed && (far || round >= longest_outside))
+            break;
+
+        pending.swap(next);
+        std::fill(next.begin(), next.end(), 0);
+    }
+
+    return round;
+}
+
+/**
+ * @brief writes the file of material to directory, the file only gets its name once it is complete.
+ *
+ * @param directory
+ * @param material
+ * @param values
+ * @return true
+ * @return false
+ */
+bool write(const std::string& directory, const Material& material, const std::vector<uint8_t>& values) {
+    const std::string path = directory + "/" + material.file_name();
+    {
+        std::ofstream file(path + ".part", std::ios::binary | std::ios::trunc);
+        file.write((const char*)values.data(), values.size());
+        if (!file)
+            return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(path + ".part", path, error);
+    return !error;
+}
+
+/**
+ * @brief builds the tablebase of all the positions with up to pieces pieces in directory, one file per material.
+ * materials are built from the fewest pieces, and for the same number of pieces from the fewest men,
+ * so every move leaves the material or leads to one that was already built.
+ * files already in directory are kept, so a build that was stopped continues from the material it stopped at.
+ *
+ * usage: tbgen <directory> <pieces> [threads]
+ */
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <directory> <pieces> [threads]" << std::endl;
+        return 1;
+    }
+
+    const std::string directory = argv[1];
+    const unsigned int pieces = std::stoul(argv[2]);
+    const unsigned int threads = argc > 3 ? std::stoul(argv[3]) : std::max(std::thread::hardware_concurrency(), 1U);
+
+    if (pieces < 2 || pieces > MAX_TABLEBASE_PIECES) {
+        std::cerr << "pieces must be between 2 and " << MAX_TABLEBASE_PIECES << std::endl;
+        return 1;
+    }
+
+    std::filesystem::create_directories(directory);
+    Tablebase tablebase;
+    std::cout << "found " << tablebase.load(directory) << " files in " << directory << std::endl;
+
+    std::vector<uint8_t> values;
+    for (uint8_t total = 2; total <= pieces; total++) {
+        for (uint8_t men = 0; men <= total; men++) {
+            for (uint8_t black_men = 0; black_men <= men; black_men++) {
+                for (uint8_t black_kings = 0; black_kings <= total - men; black_kings++) {
+                    const Material material{ black_men, black_kings, (uint8_t)(men - black_men), (uint8_t)(total - men - black_kings) };
+                    if (material.black_men + material.black_kings == 0 || material.white_men + material.white_kings == 0)
+                        continue;
+                    if (tablebase.contains(material))
+                        continue;
+                    if (!dependencies_loaded(tablebase, material))
+                        return 1;
+
+                    const auto start = std::chrono::steady_clock::now();
+                    const unsigned int rounds = solve(tablebase, material, threads, values);
+                    if (!write(directory, material, values) || !tablebase.load(directory, material)) {
+                        std::cerr << "failed to write " << material.file_name() << std::endl;
+                        return 1;
+                    }
+
+                    uint64_t wins = 0, losses = 0, draws = 0;
+                    for (const uint8_t value : values) {
+                        wins += value != TABLEBASE_INVALID && value != TABLEBASE_DRAW && !(value & 1);
+                        losses += value != TABLEBASE_INVALID && (value & 1);
+                        draws += value == TABLEBASE_DRAW;
+                    }
+
+                    std::cout << material.file_name() << ": " << values.size() << " positions, " << wins << " won, " << losses << " lost, "
+                        << draws << " drawn, " << rounds << " rounds, "
+                        << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s" << std::endl;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "transposition.hpp"
+
+// layout of a slot's data word.
+constexpr unsigned int SCORE_SHIFT = 0;
+constexpr unsigned int DEPTH_SHIFT = 16;
+constexpr unsigned int BOUND_SHIFT = 24;
+constexpr unsigned int FROM_SHIFT = 26;
+constexpr unsigned int HAS_MOVE_SHIFT = 31;
+constexpr unsigned int GENERATION_SHIFT = 32;
+constexpr unsigned int ROUTE_SHIFT = 40;
+constexpr uint64_t SQUARE_MASK = NUMBER_OF_REACHABLE_SQUARES - 1;
+// the route takes the rest of the word, enough for the path of the longest series of captures.
+constexpr uint64_t ROUTE_MASK = (1ULL << (64 - ROUTE_SHIFT)) - 1;
+
+TranspositionTable::TranspositionTable(const std::size_t megabytes) : mask(0), generation(0) {
+    this->resize(megabytes);
+}
+
+/**
+ * @brief reallocates the table to the largest power of two number of buckets that fits in megabytes, the table is emptied.
+ *
+ * @param megabytes
+ */
+void TranspositionTable::resize(const std::size_t megabytes) {
+    std::size_t count = 1;
+    while (2 * count * sizeof(Bucket) <= std::max<std::size_t>(megabytes, 1) << 20)
+        count <<= 1;
+
+    // value-initialized => all slots are empty.
+    this->buckets = std::make_unique<Bucket[]>(count);
+    this->mask = count - 1;
+    this->generation = 0;
+}
+
+/**
+ * @brief marks the beginning of a new search, entries of older searches are the first to be replaced.
+ *
+ */
+void TranspositionTable::new_search() {
+    this->generation++;
+}
+
+uint64_t TranspositionTable::pack(const TableEntry& entry, const uint8_t generation) {
+    return ((uint64_t)(uint16_t)entry.score << SCORE_SHIFT)
+        | ((uint64_t)entry.depth << DEPTH_SHIFT)
+        | ((uint64_t)entry.bound << BOUND_SHIFT)
+        | ((uint64_t)(entry.from & SQUARE_MASK) << FROM_SHIFT)
+        | ((uint64_t)entry.has_move << HAS_MOVE_SHIFT)
+        | ((uint64_t)generation << GENERATION_SHIFT)
+        | ((uint64_t)(entry.route & ROUTE_MASK) << ROUTE_SHIFT);
+}
+
+TableEntry TranspositionTable::unpack(const uint64_t data) {
+    return TableEntry{
+        (short)(uint16_t)(data >> SCORE_SHIFT),
+        (uint8_t)(data >> DEPTH_SHIFT),
+        (Bound)((data >> BOUND_SHIFT) & 3),
+        (uint8_t)((data >> FROM_SHIFT) & SQUARE_MASK),
+        (uint32_t)((data >> ROUTE_SHIFT) & ROUTE_MASK),
+        (bool)((data >> HAS_MOVE_SHIFT) & 1)
+    };
+}
+
+uint8_t TranspositionTable::generation_of(const uint64_t data) {
+    return (uint8_t)(data >> GENERATION_SHIFT);
+}
+
+/**
+ * @brief looks for the position with zobrist key in the table, returns true and fills entry if it was found.
+ *
+ * @param key
+ * @param entry
+ * @return true
+ * @return false
+ */
+bool TranspositionTable::probe(const uint64_t key, TableEntry& entry) const {
+    const Bucket& bucket = this->buckets[key & this->mask];
+
+    for (const auto& slot : bucket.slots) {
+        const uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.check.load(std::memory_order_relaxed) ^ data) == key && data != 0) {
+            entry = unpack(data);
+            return entry.bound != Bound::NONE;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief saves the result of searching the position with zobrist key to depth.
+ * replaces the position's own slot, otherwise the slot of an older search, otherwise the shallowest slot.
+ *
+ * @param key
+ * @param score
+ * @param depth
+ * @param bound
+ * @param best may be nullptr if there is no best move.
+ */
+void TranspositionTable::store(const uint64_t key, const short score, const unsigned int depth, const Bound bound, const Move* best) {
+    Bucket& bucket = this->buckets[key & this->mask];
+    Slot* victim = &bucket.slots[0];
+    int victim_worth = INT32_MAX;
+
+    for (auto& slot : bucket.slots) {
+        const uint64_t data = slot.data.load(std::memory_order_relaxed);
+
+        if ((slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+            victim = &slot;
+            break;
+        }
+
+        // entries of the current search are worth keeping over anything from an older one.
+        const int worth = unpack(data).depth + (generation_of(data) == this->generation ? 256 : 0);
+        if (worth < victim_worth) {
+            victim = &slot;
+            victim_worth = worth;
+        }
+    }
+
+    TableEntry entry{ score, (uint8_t)std::min(depth, 255U), bound, 0, 0, best != nullptr };
+    if (best != nullptr) {
+        entry.from = best->from;
+        entry.route = move_route(*best);
+    }
+
+    const uint64_t data = pack(entry, this->generation);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+    victim->data.store(data, std::memory_order_relaxed);
+}
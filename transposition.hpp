@@ -0,0 +1,88 @@
+#ifndef TRANSPOSITION_HPP
+#define TRANSPOSITION_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+#include "consts.hpp"
+#include "move.hpp"
+
+enum class Bound : uint8_t {
+    NONE = 0,
+    // the score is the exact evaluation of the position.
+    EXACT = 1,
+    // the evaluation is at least the score.
+    LOWER = 2,
+    // the evaluation is at most the score.
+    UPPER = 3
+};
+
+/**
+ * @brief what tells a move apart from the other moves of its position with the same source: the diagonals of its jumps for a series of captures,
+ * the destination for a step. captures are forced, so the moves of a position are either all captures or all steps,
+ * and a series of captures never continues another one, so no two of them share a path.
+ *
+ * @param move
+ * @return uint32_t
+ */
+inline uint32_t move_route(const Move& move) {
+    return move.captured ? move.path : move.to;
+}
+
+struct TableEntry {
+    short score;
+    // depth the position was searched to.
+    uint8_t depth;
+    Bound bound;
+    // source and route of the best move found, only meaningful if has_move.
+    uint8_t from;
+    uint32_t route;
+    bool has_move;
+
+    /**
+     * @brief is move the best move of the entry.
+     *
+     * @param move
+     * @return true
+     * @return false
+     */
+    bool holds(const Move& move) const {
+        return this->has_move && move.from == this->from && move_route(move) == this->route;
+    }
+};
+
+/**
+ * @brief a fixed-size hash table of searched positions, shared by all the search threads without any locks.
+ * every slot keeps its data next to key ^ data, a slot torn by two threads writing it at once fails the check on probe
+ * and is treated as a miss, so a wrong entry is never returned.
+ */
+class TranspositionTable {
+private:
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    // a bucket fills exactly one cache line.
+    struct alignas(64) Bucket {
+        Slot slots[4];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    std::size_t mask;
+    uint8_t generation;
+
+    static uint64_t pack(const TableEntry& entry, const uint8_t generation);
+    static TableEntry unpack(const uint64_t data);
+    static uint8_t generation_of(const uint64_t data);
+public:
+    explicit TranspositionTable(const std::size_t megabytes = DEFAULT_TABLE_MEGABYTES);
+    void resize(const std::size_t megabytes);
+    void new_search();
+    bool probe(const uint64_t key, TableEntry& entry) const;
+    void store(const uint64_t key, const short score, const unsigned int depth, const Bound bound, const Move* best);
+};
+
+#endif // TRANSPOSITION_HPP